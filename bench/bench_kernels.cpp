@@ -0,0 +1,82 @@
+#include "olcPixelGameEngine.h"
+#include "olcPGEX_MiniAudio.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// Microbenchmark for the mixing kernels, every path this machine supports
+// is run over the same stereo buffers and reported in frames per microsecond.
+
+using Kernels = olc::MiniAudio::Kernels;
+
+constexpr size_t CHANNELS = 2;
+constexpr size_t ITERATIONS = 20000;
+
+template<typename Func>
+double frames_per_microsecond(const size_t frames, Func&& kernel)
+{
+    // warm up the caches and, for AVX2, the wide execution units
+    for(size_t i = 0; i < ITERATIONS / 10; i++)
+        kernel();
+
+    auto start = std::chrono::steady_clock::now();
+    
+    for(size_t i = 0; i < ITERATIONS; i++)
+        kernel();
+    
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return (static_cast<double>(frames) * ITERATIONS) / elapsed.count();
+}
+
+int main()
+{
+    const Kernels::Path paths[] = {
+        Kernels::Path::Scalar,
+        Kernels::Path::SSE2,
+        Kernels::Path::AVX2,
+        Kernels::Path::NEON,
+        Kernels::Path::WasmSIMD,
+    };
+
+    std::printf("best path: %s\n\n", Kernels::Name(Kernels::Best()));
+    std::printf("%-10s %8s %14s %14s %14s\n", "path", "frames", "mix-add", "gain-mix", "clamp");
+
+    // typical period sizes, and one that doesn't divide evenly into vectors
+    for(const size_t frames : {256, 480, 1024, 4099})
+    {
+        std::vector<float> dst(frames * CHANNELS, 0.0f);
+        std::vector<float> src(frames * CHANNELS);
+
+        for(size_t i = 0; i < src.size(); i++)
+            src[i] = static_cast<float>(i % 64) / 64.0f - 0.5f;
+        
+        for(const Kernels::Path path : paths)
+        {
+            if(!Kernels::IsSupported(path))
+                continue;
+
+            const double mixAdd = frames_per_microsecond(frames, [&]
+            {
+                Kernels::MixAdd(dst.data(), src.data(), dst.size(), path);
+            });
+            
+            const double gainMix = frames_per_microsecond(frames, [&]
+            {
+                Kernels::MixAddGain(dst.data(), src.data(), 0.5f, dst.size(), path);
+            });
+            
+            const double clamp = frames_per_microsecond(frames, [&]
+            {
+                Kernels::Clamp(dst.data(), dst.size(), path);
+            });
+
+            std::printf("%-10s %8zu %14.1f %14.1f %14.1f\n", Kernels::Name(path), frames, mixAdd, gainMix, clamp);
+        }
+    }
+
+    // keep the optimizer honest
+    std::vector<float> check(64, 0.25f);
+    Kernels::MixAdd(check.data(), check.data(), check.size(), Kernels::Best());
+    return check[0] == 0.5f ? 0 : 1;
+}
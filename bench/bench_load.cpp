@@ -0,0 +1,417 @@
+#include "olcPixelGameEngine.h"
+#include "olcPGEX_MiniAudio.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <psapi.h>
+#elif defined(__unix__) || defined(__APPLE__)
+    #include <sys/resource.h>
+#endif
+
+// Benchmark for loading and decoding sounds. It writes a synthetic set of
+// WAV files (or copies of a file you hand it, say an MP3), packs them into
+// an olc::ResourcePack and loads the set from disk and from the pack.
+//
+// For each source there are three rows:
+//   stages          - LoadSound one file at a time, the call itself timed apart
+//                     from the decoding the job threads do after it returns.
+//                     the call reads a packed file out of the pack, a file on
+//                     disk is mapped and paged in by the decoder instead
+//   LoadSound       - LoadSound for every file, one after another
+//   LoadSoundsAsync - the whole set as one batch, decoded on the job threads
+//
+// The decoded MB are read from the resource manager's own buffers, so they
+// count what was actually decoded and held, once for each file.
+//
+// The files have just been written, so disk reads come out of the page
+// cache. Drop the caches first for cold numbers. Peak RSS is for the whole
+// process up to the end of that row, it only ever goes up.
+//
+// usage: bench_load [--files N] [--seconds S] [--format s16|s24|s32|f32]
+//                   [--rate HZ] [--channels N] [--source FILE]
+//                   [--dir PATH] [--output csv|json]
+
+struct Options
+{
+    int files = 100;
+    double seconds = 2.0;
+    ma_format format = ma_format_s16;
+    ma_uint32 sampleRate = 44100;
+    ma_uint32 channels = 2;
+    std::string source;
+    std::string directory = "bench_load_assets";
+    bool json = false;
+};
+
+struct Result
+{
+    std::string source;
+    std::string method;
+    double encodedMegabytes = 0.0;
+    double decodedMegabytes = 0.0;
+    double totalMilliseconds = 0.0;
+    double firstPlayableMilliseconds = 0.0;
+    double callMilliseconds = 0.0;
+    double decodeMilliseconds = 0.0;
+    double peakRssMegabytes = 0.0;
+};
+
+using Clock = std::chrono::steady_clock;
+
+// the PGEX needs a PixelGameEngine to register with, it's never started
+olc::PixelGameEngine pge;
+
+ma_resource_manager_data_source* data_source(olc::MiniAudio& ma, const int id)
+{
+    return static_cast<ma_resource_manager_data_source*>(ma_sound_get_data_source(ma.GetSound(id)));
+}
+
+// the same non-blocking check the PGEX uses, a decoded sound is only done once all of it is
+bool is_loaded(olc::MiniAudio& ma, const int id)
+{
+    return ma_resource_manager_data_source_result(data_source(ma, id)) != MA_BUSY;
+}
+
+double milliseconds_since(const Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double peak_rss_megabytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+    return 0.0;
+#elif defined(__unix__) || defined(__APPLE__)
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    #if defined(__APPLE__)
+        return usage.ru_maxrss / (1024.0 * 1024.0);  // bytes
+    #else
+        return usage.ru_maxrss / 1024.0;             // kilobytes
+    #endif
+#else
+    return 0.0;
+#endif
+}
+
+olc::MiniAudio::Config offline_config()
+{
+    olc::MiniAudio::Config config;
+    config.offline = true;
+    return config;
+}
+
+// what the resource manager has decoded for the sounds, each buffer counted once. encoded data counts nothing
+double decoded_megabytes(olc::MiniAudio& ma, const std::vector<int>& sounds)
+{
+    std::unordered_set<const ma_resource_manager_data_buffer_node*> counted;
+    ma_uint64 bytes = 0;
+
+    for(const int id : sounds)
+    {
+        const ma_resource_manager_data_buffer_node* node = data_source(ma, id)->backend.buffer.pNode;
+        if(!counted.insert(node).second)
+            continue;
+
+        const ma_resource_manager_data_supply& supply = node->data;
+
+        if(supply.type == ma_resource_manager_data_supply_type_decoded)
+            bytes += supply.backend.decoded.decodedFrameCount * ma_get_bytes_per_frame(supply.backend.decoded.format, supply.backend.decoded.channels);
+        else if(supply.type == ma_resource_manager_data_supply_type_decoded_paged)
+            bytes += supply.backend.decodedPaged.decodedFrameCount * ma_get_bytes_per_frame(supply.backend.decodedPaged.data.format, supply.backend.decodedPaged.data.channels);
+    }
+
+    return bytes / (1024.0 * 1024.0);
+}
+
+std::vector<std::string> write_asset_set(const Options& options)
+{
+    std::filesystem::create_directories(options.directory);
+
+    std::vector<std::string> paths;
+
+    if(!options.source.empty())
+    {
+        const std::string extension = std::filesystem::path(options.source).extension().string();
+
+        for(int i = 0; i < options.files; i++)
+        {
+            paths.push_back(std::format("{}/sound_{:04}{}", options.directory, i, extension));
+            std::filesystem::copy_file(options.source, paths.back(), std::filesystem::copy_options::overwrite_existing);
+        }
+
+        return paths;
+    }
+
+    const ma_uint64 frames = static_cast<ma_uint64>(options.seconds * options.sampleRate);
+    std::vector<float> samples(static_cast<size_t>(frames * options.channels));
+    std::vector<char> converted(static_cast<size_t>(frames * ma_get_bytes_per_frame(options.format, options.channels)));
+
+    std::srand(1138);
+
+    for(int i = 0; i < options.files; i++)
+    {
+        // a tone with a little noise on it, a different pitch for every file
+        const double frequency = 110.0 + 10.0 * i;
+        for(ma_uint64 f = 0; f < frames; f++)
+        {
+            const float tone = 0.4f * static_cast<float>(std::sin(6.283185307179586 * frequency * f / options.sampleRate));
+            for(ma_uint32 c = 0; c < options.channels; c++)
+                samples[f * options.channels + c] = tone + 0.05f * (std::rand() / static_cast<float>(RAND_MAX) - 0.5f);
+        }
+
+        ma_convert_pcm_frames_format(converted.data(), options.format, samples.data(), ma_format_f32, frames, options.channels, ma_dither_mode_none);
+
+        paths.push_back(std::format("{}/sound_{:04}.wav", options.directory, i));
+
+        ma_encoder_config config = ma_encoder_config_init(ma_encoding_format_wav, options.format, options.channels, options.sampleRate);
+        ma_encoder encoder;
+
+        if(ma_encoder_init_file(paths.back().c_str(), &config, &encoder) != MA_SUCCESS)
+            throw std::runtime_error{std::format("failed to write {}", paths.back())};
+
+        ma_encoder_write_pcm_frames(&encoder, converted.data(), frames, nullptr);
+        ma_encoder_uninit(&encoder);
+    }
+
+    return paths;
+}
+
+double encoded_megabytes(const std::vector<std::string>& paths)
+{
+    std::uintmax_t bytes = 0;
+    for(const std::string& path : paths)
+        bytes += std::filesystem::file_size(path);
+
+    return bytes / (1024.0 * 1024.0);
+}
+
+// LoadSound for one file at a time, waiting for each to decode before the next
+Result bench_stages(const std::vector<std::string>& paths, olc::ResourcePack* pack)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    Result result;
+    std::vector<int> sounds;
+
+    for(size_t i = 0; i < paths.size(); i++)
+    {
+        auto start = Clock::now();
+        sounds.push_back(ma.LoadSound(paths[i], pack, false, olc::MiniAudio::LoadMode::Decode));
+        const double call = milliseconds_since(start);
+
+        start = Clock::now();
+        while(!is_loaded(ma, sounds.back()))
+            std::this_thread::yield();
+        const double decode = milliseconds_since(start);
+
+        if(i == 0)
+            result.firstPlayableMilliseconds = call + decode;
+
+        result.callMilliseconds += call;
+        result.decodeMilliseconds += decode;
+    }
+
+    result.method = "stages";
+    result.totalMilliseconds = result.callMilliseconds + result.decodeMilliseconds;
+    result.decodedMegabytes = decoded_megabytes(ma, sounds);
+    result.peakRssMegabytes = peak_rss_megabytes();
+    return result;
+}
+
+Result bench_load_sound(const std::vector<std::string>& paths, olc::ResourcePack* pack)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    Result result;
+    std::vector<int> sounds;
+
+    auto start = Clock::now();
+
+    for(const std::string& path : paths)
+    {
+        sounds.push_back(ma.LoadSound(path, pack, false, olc::MiniAudio::LoadMode::Decode));
+
+        // wait for the first sound to finish decoding before loading the rest
+        if(sounds.size() == 1)
+        {
+            while(!is_loaded(ma, sounds.front()))
+                std::this_thread::yield();
+
+            result.firstPlayableMilliseconds = milliseconds_since(start);
+        }
+    }
+
+    for(const int id : sounds)
+    {
+        while(!is_loaded(ma, id))
+            std::this_thread::yield();
+    }
+
+    result.totalMilliseconds = milliseconds_since(start);
+    result.decodedMegabytes = decoded_megabytes(ma, sounds);
+    result.method = "LoadSound";
+    result.peakRssMegabytes = peak_rss_megabytes();
+    return result;
+}
+
+Result bench_load_sounds_async(const std::vector<std::string>& paths, olc::ResourcePack* pack)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    Result result;
+
+    auto start = Clock::now();
+
+    const int batch = ma.LoadSoundsAsync(paths, pack, olc::MiniAudio::LoadMode::Decode);
+
+    // poll the way a loading screen would, until the first sound is ready
+    while(ma.GetLoadProgress(batch) == 0.0f)
+        std::this_thread::yield();
+
+    result.firstPlayableMilliseconds = milliseconds_since(start);
+
+    ma.WaitForLoad(batch);
+    result.totalMilliseconds = milliseconds_since(start);
+
+    result.decodedMegabytes = decoded_megabytes(ma, ma.GetBatchSounds(batch));
+    result.method = "LoadSoundsAsync";
+    result.peakRssMegabytes = peak_rss_megabytes();
+    return result;
+}
+
+void print_csv(const std::vector<Result>& results)
+{
+    std::printf("source,method,encoded_mb,decoded_mb,total_ms,first_playable_ms,decoded_mb_per_s,call_ms,decode_ms,peak_rss_mb\n");
+
+    for(const Result& r : results)
+    {
+        std::printf("%s,%s,%.3f,%.3f,%.3f,%.3f,%.2f,%.3f,%.3f,%.2f\n",
+            r.source.c_str(), r.method.c_str(), r.encodedMegabytes, r.decodedMegabytes,
+            r.totalMilliseconds, r.firstPlayableMilliseconds, r.decodedMegabytes / (r.totalMilliseconds / 1000.0),
+            r.callMilliseconds, r.decodeMilliseconds, r.peakRssMegabytes);
+    }
+}
+
+void print_json(const std::vector<Result>& results, const Options& options, const int files)
+{
+    std::printf("{\n  \"files\": %d,\n  \"source\": \"%s\",\n  \"results\": [\n",
+        files, options.source.empty() ? "synthetic wav" : options.source.c_str());
+
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        const Result& r = results[i];
+        std::printf("    {\"source\": \"%s\", \"method\": \"%s\", \"encoded_mb\": %.3f, \"decoded_mb\": %.3f, "
+            "\"total_ms\": %.3f, \"first_playable_ms\": %.3f, \"decoded_mb_per_s\": %.2f, "
+            "\"call_ms\": %.3f, \"decode_ms\": %.3f, \"peak_rss_mb\": %.2f}%s\n",
+            r.source.c_str(), r.method.c_str(), r.encodedMegabytes, r.decodedMegabytes,
+            r.totalMilliseconds, r.firstPlayableMilliseconds, r.decodedMegabytes / (r.totalMilliseconds / 1000.0),
+            r.callMilliseconds, r.decodeMilliseconds, r.peakRssMegabytes,
+            (i + 1 < results.size()) ? "," : "");
+    }
+
+    std::printf("  ]\n}\n");
+}
+
+bool parse_format(const char* name, ma_format& format)
+{
+    if(std::strcmp(name, "s16") == 0) format = ma_format_s16;
+    else if(std::strcmp(name, "s24") == 0) format = ma_format_s24;
+    else if(std::strcmp(name, "s32") == 0) format = ma_format_s32;
+    else if(std::strcmp(name, "f32") == 0) format = ma_format_f32;
+    else return false;
+
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+
+    for(int i = 1; i < argc; i++)
+    {
+        bool ok = (i + 1 < argc);
+
+        if(ok && std::strcmp(argv[i], "--files") == 0)
+            options.files = std::atoi(argv[++i]);
+        else if(ok && std::strcmp(argv[i], "--seconds") == 0)
+            options.seconds = std::atof(argv[++i]);
+        else if(ok && std::strcmp(argv[i], "--format") == 0)
+            ok = parse_format(argv[++i], options.format);
+        else if(ok && std::strcmp(argv[i], "--rate") == 0)
+            options.sampleRate = static_cast<ma_uint32>(std::atoi(argv[++i]));
+        else if(ok && std::strcmp(argv[i], "--channels") == 0)
+            options.channels = static_cast<ma_uint32>(std::atoi(argv[++i]));
+        else if(ok && std::strcmp(argv[i], "--source") == 0)
+            options.source = argv[++i];
+        else if(ok && std::strcmp(argv[i], "--dir") == 0)
+            options.directory = argv[++i];
+        else if(ok && std::strcmp(argv[i], "--output") == 0)
+            options.json = (std::strcmp(argv[++i], "json") == 0);
+        else
+            ok = false;
+
+        if(!ok)
+        {
+            std::fprintf(stderr,
+                "usage: %s [--files N] [--seconds S] [--format s16|s24|s32|f32] [--rate HZ] [--channels N]\n"
+                "          [--source FILE] [--dir PATH] [--output csv|json]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if(options.files < 1)
+        options.files = 1;
+
+    const std::vector<std::string> paths = write_asset_set(options);
+    const double encoded = encoded_megabytes(paths);
+
+    const std::string packPath = options.directory + "/assets.pack";
+    const std::string packKey = "bench_load";
+    {
+        olc::ResourcePack pack;
+        for(const std::string& path : paths)
+            pack.AddFile(path);
+        pack.SavePack(packPath, packKey);
+    }
+
+    olc::ResourcePack pack;
+    pack.LoadPack(packPath, packKey);
+
+    std::vector<Result> results;
+
+    for(olc::ResourcePack* source : {static_cast<olc::ResourcePack*>(nullptr), &pack})
+    {
+        results.push_back(bench_stages(paths, source));
+        results.push_back(bench_load_sound(paths, source));
+        results.push_back(bench_load_sounds_async(paths, source));
+    }
+
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        results[i].source = (i < 3) ? "disk" : "pack";
+        results[i].encodedMegabytes = encoded;
+    }
+
+    if(options.json)
+        print_json(results, options, options.files);
+    else
+        print_csv(results);
+
+    return 0;
+}
@@ -0,0 +1,226 @@
+#include "olcPixelGameEngine.h"
+#include "olcPGEX_MiniAudio.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Benchmark for the mixing hot path. Everything is rendered offline, no
+// device and no window, so it runs on a headless box. Each case scales
+// one kind of load and reports how much faster than realtime the mix
+// runs, along with the per-block timings from GetAudioStats.
+//
+// usage: bench_mixer [--format csv|json] [--seconds N] [--block FRAMES]
+
+struct Options
+{
+    bool json = false;
+    double seconds = 2.0;
+    ma_uint32 blockFrames = 512;
+};
+
+struct Result
+{
+    std::string benchmark;
+    int count = 0;
+    double wallMilliseconds = 0.0;
+    double realtimeFactor = 0.0;
+    olc::MiniAudio::AudioStats stats;
+};
+
+// the PGEX needs a PixelGameEngine to register with, it's never started
+olc::PixelGameEngine pge;
+
+olc::MiniAudio::Config offline_config(const Options& options, const int maxWaveforms = olc::MiniAudio::MAX_WAVEFORMS)
+{
+    olc::MiniAudio::Config config;
+    config.offline = true;
+    config.channels = 2;
+    config.sampleRate = 48000;
+    config.periodSizeInFrames = options.blockFrames;
+    config.maxWaveforms = maxWaveforms;
+    return config;
+}
+
+// renders options.seconds of audio, after a short warm up, and times it
+Result measure(olc::MiniAudio& ma, const Options& options, const std::string& benchmark, const int count)
+{
+    const ma_uint32 sampleRate = ma.GetConfig().sampleRate;
+    const ma_uint32 channels = ma.GetConfig().channels;
+    const ma_uint64 frames = static_cast<ma_uint64>(options.seconds * sampleRate);
+
+    std::vector<float> output(static_cast<size_t>(sampleRate / 10) * channels);
+
+    // warm up, this also drains any commands still queued for the mixer
+    ma.Render(output.data(), sampleRate / 10);
+    ma.ResetAudioStats();
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(ma_uint64 rendered = 0; rendered < frames;)
+    {
+        const ma_uint64 chunk = std::min<ma_uint64>(frames - rendered, sampleRate / 10);
+        ma.Render(output.data(), chunk);
+        rendered += chunk;
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    Result result;
+    result.benchmark = benchmark;
+    result.count = count;
+    result.wallMilliseconds = elapsed.count();
+    result.realtimeFactor = (options.seconds * 1000.0) / elapsed.count();
+    result.stats = ma.GetAudioStats();
+    return result;
+}
+
+Result bench_waveforms(const Options& options, const int count)
+{
+    olc::MiniAudio ma{offline_config(options, count)};
+
+    const ma_waveform_type types[] = {
+        ma_waveform_type_sine,
+        ma_waveform_type_square,
+        ma_waveform_type_triangle,
+        ma_waveform_type_sawtooth,
+    };
+
+    std::vector<float> drain(static_cast<size_t>(options.blockFrames) * 2);
+
+    for(int i = 0; i < count; i++)
+    {
+        const int id = ma.CreateWaveform(0.5 / count, 110.0 + i, types[i % 4]);
+        ma.PlayWaveform(id);
+
+        // two commands per waveform, let the mixer catch up before the queue fills
+        if((i + 1) % (olc::MiniAudio::MAX_PENDING_COMMANDS / 4) == 0)
+            ma.Render(drain.data(), options.blockFrames);
+    }
+
+    return measure(ma, options, "waveforms", count);
+}
+
+Result bench_sounds(const Options& options, const int count)
+{
+    olc::MiniAudio ma{offline_config(options)};
+
+    std::vector<std::string> paths(count, "assets/sounds/SampleA.wav");
+    const int batch = ma.LoadSoundsAsync(paths, nullptr, olc::MiniAudio::LoadMode::Decode);
+    ma.WaitForLoad(batch);
+
+    for(const int id : ma.GetBatchSounds(batch))
+    {
+        ma.SetVolume(id, 1.0f / count);
+        ma.Play(id, true);
+    }
+
+    return measure(ma, options, "decoded_sounds", count);
+}
+
+Result bench_noise(const Options& options, const int oscillators)
+{
+    olc::MiniAudio ma{offline_config(options)};
+
+    const float sampleRate = static_cast<float>(ma.GetConfig().sampleRate);
+
+    ma.SetNoiseBlockCallback([oscillators, sampleRate](float* noiseData, const ma_uint32 frameCount, const ma_uint32 channels, const ma_uint64 frameClock)
+    {
+        for(ma_uint32 i = 0; i < frameCount; i++)
+        {
+            const float time = static_cast<float>(frameClock + i) / sampleRate;
+            float sample = 0.0f;
+
+            for(int o = 0; o < oscillators; o++)
+                sample += std::sin(6.2831853f * (110.0f + o) * time);
+
+            sample *= (oscillators > 0) ? 0.5f / oscillators : 0.0f;
+
+            for(ma_uint32 c = 0; c < channels; c++)
+                noiseData[i * channels + c] = sample;
+        }
+    });
+
+    return measure(ma, options, "noise_oscillators", oscillators);
+}
+
+void print_csv(const std::vector<Result>& results, const Options& options)
+{
+    std::printf("benchmark,count,block_frames,seconds,wall_ms,realtime_factor,callbacks,min_us,avg_us,p99_us,max_us,avg_dsp_load,max_dsp_load,late_callbacks\n");
+
+    for(const Result& r : results)
+    {
+        std::printf("%s,%d,%u,%.3f,%.3f,%.2f,%llu,%.3f,%.3f,%.3f,%.3f,%.5f,%.5f,%llu\n",
+            r.benchmark.c_str(), r.count, options.blockFrames, options.seconds,
+            r.wallMilliseconds, r.realtimeFactor,
+            static_cast<unsigned long long>(r.stats.callbacks),
+            r.stats.minMicroseconds, r.stats.averageMicroseconds, r.stats.p99Microseconds, r.stats.maxMicroseconds,
+            r.stats.averageDspLoad, r.stats.maxDspLoad,
+            static_cast<unsigned long long>(r.stats.lateCallbacks));
+    }
+}
+
+void print_json(const std::vector<Result>& results, const Options& options)
+{
+    std::printf("{\n  \"kernel_path\": \"%s\",\n  \"block_frames\": %u,\n  \"seconds\": %.3f,\n  \"results\": [\n",
+        olc::MiniAudio::Kernels::Name(olc::MiniAudio::Kernels::Best()), options.blockFrames, options.seconds);
+
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        const Result& r = results[i];
+        std::printf("    {\"benchmark\": \"%s\", \"count\": %d, \"wall_ms\": %.3f, \"realtime_factor\": %.2f, \"callbacks\": %llu, "
+            "\"min_us\": %.3f, \"avg_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f, "
+            "\"avg_dsp_load\": %.5f, \"max_dsp_load\": %.5f, \"late_callbacks\": %llu}%s\n",
+            r.benchmark.c_str(), r.count, r.wallMilliseconds, r.realtimeFactor,
+            static_cast<unsigned long long>(r.stats.callbacks),
+            r.stats.minMicroseconds, r.stats.averageMicroseconds, r.stats.p99Microseconds, r.stats.maxMicroseconds,
+            r.stats.averageDspLoad, r.stats.maxDspLoad,
+            static_cast<unsigned long long>(r.stats.lateCallbacks),
+            (i + 1 < results.size()) ? "," : "");
+    }
+
+    std::printf("  ]\n}\n");
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+            options.json = (std::strcmp(argv[++i], "json") == 0);
+        else if(std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+            options.seconds = std::atof(argv[++i]);
+        else if(std::strcmp(argv[i], "--block") == 0 && i + 1 < argc)
+            options.blockFrames = static_cast<ma_uint32>(std::atoi(argv[++i]));
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--format csv|json] [--seconds N] [--block FRAMES]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+
+    for(const int count : {1, 10, 100, 1000, 10000})
+        results.push_back(bench_waveforms(options, count));
+
+    for(const int count : {1, 8, 32, 128})
+        results.push_back(bench_sounds(options, count));
+
+    for(const int oscillators : {0, 1, 16, 256})
+        results.push_back(bench_noise(options, oscillators));
+
+    if(options.json)
+        print_json(results, options);
+    else
+        print_csv(results, options);
+
+    return 0;
+}
@@ -14,13 +14,35 @@ public:
 public:
     bool OnUserCreate() override
     {
+        /**
+         * buses group sounds together, so a whole group can be
+         * controlled with one call. one for the music and one for
+         * the sound effects, both feeding straight into the output.
+         * 
+         * returns a bus ID (int), to load sounds into and control with.
+         */
+        musicBus = ma.CreateBus();
+        effectsBus = ma.CreateBus();
+
         /**
          * load a sample from a file. currently decodes WAV and MP3
          * files without further coding or configuration.
          * 
+         * the song is long, so it's streamed, decoded a page at a
+         * time as it plays instead of all at once up front.
+         * 
          * returns a sample ID (int), for control and expression calls.
          */
-        song1 = ma.LoadSound("assets/sounds/song1.mp3");
+        song1 = ma.LoadSound("assets/sounds/song1.mp3", nullptr, false, olc::MiniAudio::LoadMode::Stream, musicBus);
+
+        /**
+         * load a sample as a sound bank, with 8 voices sharing the
+         * same decoded data. playing it is cheap, there's nothing to
+         * load, perfect for sounds you fire a lot.
+         * 
+         * returns a sound bank ID (int), for PlaySoundBank.
+         */
+        sampleBank = ma.LoadSoundBank("assets/sounds/SampleB.wav", 8, nullptr, effectsBus);
 
         /**
          * this is here to demonstrate how the adventurous can
@@ -45,7 +67,27 @@ public:
 
         if(GetKey(olc::S).bPressed)
         {
-            ma.Play("assets/sounds/SampleA.wav");
+            ma.Play("assets/sounds/SampleA.wav", nullptr, effectsBus);
+        }
+
+        if(GetKey(olc::B).bPressed)
+        {
+            /**
+             * PlaySoundBank takes a sound bank ID (int) and plays
+             * its next voice, restarting the oldest one if all
+             * of them are busy.
+             */
+            ma.PlaySoundBank(sampleBank);
+        }
+
+        if(GetKey(olc::K2).bPressed)
+        {
+            /**
+             * SetBusVolume takes a bus ID (int) and a float 0.0f
+             * to 1.0f, and applies to every sound in the bus at once.
+             */
+            effectsMuted = !effectsMuted;
+            ma.SetBusVolume(effectsBus, (effectsMuted) ? 0.0f : 1.0f);
         }
 
         if(GetKey(olc::SPACE).bPressed)
@@ -151,7 +193,11 @@ public:
             "\n"
             "One-Off Sounds <" + std::to_string(ma.GetOneOffCount()) + ">   S\n" \
             "\n" \
-            "BackgroundPlay <" + ((backgroundPlay) ? "On": "Off") + "> K1\n",
+            "Sound Bank                B\n" \
+            "\n" \
+            "BackgroundPlay <" + ((backgroundPlay) ? "On": "Off") + "> K1\n" \
+            "\n" \
+            "Mute Effects <" + ((effectsMuted) ? "On": "Off") + ">   K2\n",
         olc::WHITE, {0.5f, 0.5f});
 
         olc::vi2d center = (GetScreenSize() / 2);
@@ -186,6 +232,13 @@ public:
     // To keep track of our sample ID
     int song1;
     
+    // To keep track of our sound bank ID
+    int sampleBank;
+
+    // To keep track of our bus IDs
+    int musicBus;
+    int effectsBus;
+    
     // For demonstration controls, with sensible default values
     float pan    = 0.0f;
     float pitch  = 1.0f;
@@ -193,6 +246,7 @@ public:
     float volume = 1.0f;
     float distance = 0.0f;
     bool backgroundPlay = false;
+    bool effectsMuted = false;
     ma_uint64 cursor = 0ull;
 
 };
@@ -3,7 +3,6 @@
 
 constexpr int NOTE_COUNT = 17;
 constexpr float thirtyFramesPerSecond = 1.0f / 30.f;
-constexpr float PI = 3.14159f;
 
 class DemoSynthesis : public olc::PixelGameEngine
 {
@@ -24,37 +23,48 @@ public:
 
     bool OnUserCreate() override
     {
-		instruments.emplace_back(std::make_unique<Harmonica>());
-		instruments.emplace_back(std::make_unique<Bell>());
-		instruments.emplace_back(std::make_unique<Bell8>());
-		instruments.emplace_back(std::make_unique<SawAnalog>());
-
-		// This is it... This is how we interface into the miniaudio engine any noise we want heard!
-		// Fill up the noiseLeftChannel and noiseRightChannel with a value at any given moment...
-		// Accumulate fElapsedTime so that we know how much total time has passed so we can play the correct synthesized sound based on delta time.
-        noiseCallbackFunc = [this](float& noiseLeftChannel, float& noiseRightChannel, const float fElapsedTime)->void{
-			noiseLeftChannel = noiseRightChannel = 0.f;
-
-			for(Note& note : notes)
-			{
-				bool noteFinished{false};
-				float noise = note.instrument->sound(audioRuntime, note, noteFinished); 
-
-				noiseLeftChannel += noise * lerp(1.f, 0.f, pan/2 + 0.5f); // This lerp formula shrinks the -1 to 1 range to 0 to 1, which determines percentage of the total noise to play in each side.
-				noiseRightChannel += noise * lerp(0.f, 1.f, pan/2 + 0.5f);
-			}
-
-			// Each frame the callback receives will give us a duration that frame takes up in real time.
-			audioRuntime += fElapsedTime;
-		};
-
-		// And finally... Tell the system this is where to send audio requests to... Now we can modify audio!
-		ma.SetNoiseCallback(noiseCallbackFunc);
-
-		//Initialize an instrument for all the notes.
-		for(Note& note : notes)
-		{
-			note.instrument = instruments[selectedInstrumentInd].get();
+		// An instrument describes what a note sounds like: up to four oscillators, each pitched some semitones from the note,
+		// a little noise, a vibrato and an ADSR envelope. The synth does the rest on the audio thread, only for the notes still sounding.
+		olc::MiniAudio::Instrument harmonica;
+		harmonica.partials[0] = {ma_waveform_type_square, 0.f, 1.00f};
+		harmonica.partials[1] = {ma_waveform_type_square, 12.f, 0.50f};
+		harmonica.noise = 0.05f;
+		harmonica.vibratoHertz = 5.f;
+		harmonica.vibratoSemitones = 0.09f;
+		harmonica.envelope = {0.05f, 1.0f, 0.95f, 0.1f};
+		instruments.push_back({"Harmonica", harmonica});
+
+		olc::MiniAudio::Instrument bell;
+		bell.partials[0] = {ma_waveform_type_sine, 12.f, 1.00f};
+		bell.partials[1] = {ma_waveform_type_sine, 24.f, 0.50f};
+		bell.partials[2] = {ma_waveform_type_sine, 36.f, 0.25f};
+		bell.vibratoHertz = 5.f;
+		bell.vibratoSemitones = 0.09f;
+		bell.envelope = {0.01f, 1.0f, 0.0f, 1.0f};
+		instruments.push_back({"Bell", bell});
+
+		olc::MiniAudio::Instrument bell8;
+		bell8.partials[0] = {ma_waveform_type_square, 0.f, 1.00f};
+		bell8.partials[1] = {ma_waveform_type_sine, 12.f, 0.50f};
+		bell8.partials[2] = {ma_waveform_type_sine, 24.f, 0.25f};
+		bell8.vibratoHertz = 5.f;
+		bell8.vibratoSemitones = 0.09f;
+		bell8.envelope = {0.01f, 0.5f, 0.8f, 1.0f};
+		instruments.push_back({"Bell 8-bit", bell8});
+
+		// A band limited sawtooth, it sounds like the sum of harmonics javid's analog saw adds up by hand, for a fraction of the work.
+		olc::MiniAudio::Instrument sawAnalog;
+		sawAnalog.partials[0] = {ma_waveform_type_sawtooth, 0.f, 1.00f, true};
+		sawAnalog.vibratoHertz = 5.f;
+		sawAnalog.vibratoSemitones = 0.09f;
+		sawAnalog.envelope = {0.05f, 1.0f, 0.95f, 0.1f};
+		instruments.push_back({"Analog Saw", sawAnalog});
+
+		// Hand every instrument to the synth, keeping the ids it gives back.
+		for(InstrumentEntry& entry : instruments)
+		{
+			entry.instrument.volume = volume;
+			entry.id = ma.CreateInstrument(entry.instrument);
 		}
 
         return true;
@@ -70,31 +80,15 @@ public:
 
 		for(Note& note : notes)
 		{
-			note.instrument->volume = 0.1f;
+			// NoteOn gives back an id for the note, NoteOff lets it fade out over the instrument's release time.
+			if(GetKey(note.key).bPressed)
+				note.noteId = ma.NoteOn(instruments[selectedInstrumentInd].id, scale(note.id));
 
-			if(GetKey(note.key).bHeld)
-			{
-				// Note is not active yet, so we will play it now.
-				if(!note.active)
-				{
-					note.on = audioRuntime;
-					note.active=true;
-				}
-				else
-				if(note.off > note.on) // We pressed the key during its release phase...
-					note.on = audioRuntime;
+			if(GetKey(note.key).bReleased)
+				ma.NoteOff(note.noteId);
 
+			if(GetKey(note.key).bHeld)
 				keyPressed = true;
-			}
-			else
-			{
-				if(note.off < note.on)
-				{
-					note.off = audioRuntime;
-				}
-
-				note.active = false;
-			}
 		}
 
 		if(GetKey(olc::UP).bPressed)
@@ -107,30 +101,39 @@ public:
 				selectedInstrumentInd += instruments.size();
 		}
 
+		float newVolume{volume};
+		float newPan{pan};
+
 		if(GetKey(olc::RIGHT).bHeld)
-			volume = std::min(1.f, volume + 1.f * fElapsedTime);
+			newVolume = std::min(1.f, volume + 1.f * fElapsedTime);
 		if(GetKey(olc::LEFT).bHeld)
-			volume = std::max(0.f, volume - 1.f * fElapsedTime);
+			newVolume = std::max(0.f, volume - 1.f * fElapsedTime);
 
 		if(GetKey(olc::O).bHeld)
-			pan = std::max(-1.f, pan - 1.f * fElapsedTime);
+			newPan = std::max(-1.f, pan - 1.f * fElapsedTime);
 		if(GetKey(olc::P).bHeld)
-			pan = std::min(1.f, pan + 1.f * fElapsedTime);
+			newPan = std::min(1.f, pan + 1.f * fElapsedTime);
 
 		if(GetKey(olc::R).bPressed)
 		{
 			selectedInstrumentInd = 0;
-			volume = 0.1f;
-			pan = 0.f;
+			newVolume = 0.1f;
+			newPan = 0.f;
 		}
 
-		// Update all the notes' instruments.
-		for(Note& note : notes)
+		// Volume and pan belong to the instruments, only tell the synth when they've changed. Notes already sounding follow along.
+		if(newVolume != volume || newPan != pan)
 		{
-			note.instrument = instruments[selectedInstrumentInd].get();
-		}
+			volume = newVolume;
+			pan = newPan;
 
-		instruments[selectedInstrumentInd]->volume = volume;
+			for(InstrumentEntry& entry : instruments)
+			{
+				entry.instrument.volume = volume;
+				entry.instrument.pan = pan;
+				ma.SetInstrument(entry.id, entry.instrument);
+			}
+		}
 
         if(keyPressed)
             backgroundCol = olc::VERY_DARK_BLUE;
@@ -138,9 +141,10 @@ public:
         GradientFillRectDecal({}, {float(ScreenWidth()), ScreenHeight()/2.f}, olc::BLACK, backgroundCol, backgroundCol, olc::BLACK);
         GradientFillRectDecal({0.f, ScreenHeight()/2.f}, {float(ScreenWidth()), ScreenHeight()/2.f}, backgroundCol, olc::BLACK, olc::BLACK, backgroundCol);
 
-		DrawStringDecal({},"Instrument: <"+ instruments[selectedInstrumentInd]->name +"> UP, DOWN");
+		DrawStringDecal({},"Instrument: <"+ instruments[selectedInstrumentInd].name +"> UP, DOWN");
 		DrawStringDecal({0.f, 8.f},"Volume: <"+ std::to_string(volume) +"> LEFT, RIGHT");
 		DrawStringDecal({0.f, 16.f},"Pan: <"+ std::to_string(pan) +"> O, P");
+		DrawStringDecal({0.f, 24.f},"Voices: "+ std::to_string(ma.GetActiveVoiceCount()));
 
 		DrawStringDecal({0.f, 120.f},"Reset Settings <R>");
 
@@ -154,34 +158,30 @@ public:
         #endif
     }
 
-    // The instance of the audio engine, no fancy config required.
-    olc::MiniAudio ma;
+    bool OnUserDestroy() override
+    {
+		//Let's be nice and cleanup after ourselves...
+		for(InstrumentEntry& entry : instruments)
+			ma.UnloadInstrument(entry.id);
 
-	std::function<void(float& noiseLeftChannel, float& noiseRightChannel, const float fElapsedTime)> noiseCallbackFunc;
+        return true;
+    }
 
-	double audioRuntime{}; // A running timer of how long the audio engine has been running.
+    // The instance of the audio engine, no fancy config required.
+    olc::MiniAudio ma;
 
 	float volume{0.1f};
 	float pan{0.0f}; // -1.f for only left channel, 1.f for only right channel
-	
-	struct Instrument;
 
 	struct Note
 	{
 		std::string displayStr;
 		olc::Key key;
 		int id;		// Position in scale
-		float on;	// Time note was activated
-		float off;	// Time note was deactivated
-		bool active;
-		Instrument*instrument;
+		int noteId;	// The synth's id for the note while it's playing
 
 		Note(std::string displayStr, olc::Key key, int id)
-		:displayStr(displayStr), key(key), id(id){
-			on = 0.0;
-			off = 0.0;
-			active = false;
-		}
+		:displayStr(displayStr), key(key), id(id), noteId(-1){}
 	};
 
     std::array<Note,NOTE_COUNT>notes{
@@ -205,8 +205,15 @@ public:
         {"C" , olc::OEM_2,	15},
     };
 
+	struct InstrumentEntry
+	{
+		std::string name;
+		olc::MiniAudio::Instrument instrument;
+		int id{-1};
+	};
+
 	int selectedInstrumentInd{};
-	std::vector<std::unique_ptr<Instrument>>instruments;
+	std::vector<InstrumentEntry>instruments;
 
     const std::string piano{
 	    "  | |   |   |   |   | |   |   |   |   | |   | |   |   |   |\n"
@@ -217,256 +224,10 @@ public:
 	    "|_____|_____|_____|_____|_____|_____|_____|_____|_____|_____|"
     };
 
-    enum class Oscillator
-	{
-		SINE,
-		SQUARE,
-		TRIANGLE,
-		SAW_ANALOG,
-		SAW_DIGITAL,
-		NOISE,
-	};
-
-	float lerp(float n1,float n2,double t){
-		return float(n1*(1-t)+n2*t);
-	}
-
-	// Converts frequency (Hz) to angular velocity
-	static float w(const float hertz)
-	{
-		return hertz * 2.0 * PI;
-	}
-
-	static float osc(const float time, const float hertz, const Oscillator type = Oscillator::SINE,
-		const float LFOHertz = 0.0, const float LFOAmplitude = 0.0, float custom = 50.0)
-	{
-
-		float freq = w(hertz) * time + LFOAmplitude * hertz * (sin(w(LFOHertz) * time));
-
-		switch (type)
-		{
-			case Oscillator::SINE: // Sine wave bewteen -1 and +1
-				return sin(freq);
-
-			case Oscillator::SQUARE: // Square wave between -1 and +1
-				return sin(freq) > 0 ? 1.0 : -1.0;
-
-			case Oscillator::TRIANGLE: // Triangle wave between -1 and +1
-				return asin(sin(freq)) * (2.0 / PI);
-
-			case Oscillator::SAW_ANALOG: // Saw wave (analogue / warm / slow)
-			{
-				float dOutput = 0.0;
-				for (float n = 1.0; n < custom; n++)
-					dOutput += (sin(n*freq)) / n;
-				return dOutput * (2.0 / PI);
-			}
-
-			case Oscillator::SAW_DIGITAL:
-				return atan(tan(freq));
-
-			case Oscillator::NOISE:
-				return 2.0 * ((float)rand() / (float)RAND_MAX) - 1.0;
-
-			default:
-				return 0.0;
-		}
-	}
-
-	//Abstract envelope class
-	struct Envelope
-	{
-		virtual float amplitude(const float time, const float timeOn, const float timeOff) = 0;
-	};
-
-	struct EnvelopeADSR : public Envelope
-	{
-		float attackTime;
-		float decayTime;
-		float sustainAmplitude;
-		float releaseTime;
-		float startAmplitude;
-
-		EnvelopeADSR()
-		{
-			attackTime = 0.1;
-			decayTime = 0.1;
-			sustainAmplitude = 1.0;
-			releaseTime = 0.2;
-			startAmplitude = 1.0;
-		}
-
-		virtual float amplitude(const float time, const float timeOn, const float timeOff)
-		{
-			float dAmplitude = 0.0;
-			float dReleaseAmplitude = 0.0;
-
-			if (timeOn > timeOff) // Note is on
-			{
-				float dLifeTime = time - timeOn;
-
-				if (dLifeTime <= attackTime)
-					dAmplitude = (dLifeTime / attackTime) * startAmplitude;
-
-				if (dLifeTime > attackTime && dLifeTime <= (attackTime + decayTime))
-					dAmplitude = ((dLifeTime - attackTime) / decayTime) * (sustainAmplitude - startAmplitude) + startAmplitude;
-
-				if (dLifeTime > (attackTime + decayTime))
-					dAmplitude = sustainAmplitude;
-			}
-			else // Note is off
-			{
-				float dLifeTime = timeOff - timeOn;
-
-				if (dLifeTime <= attackTime)
-					dReleaseAmplitude = (dLifeTime / attackTime) * startAmplitude;
-
-				if (dLifeTime > attackTime && dLifeTime <= (attackTime + decayTime))
-					dReleaseAmplitude = ((dLifeTime - attackTime) / decayTime) * (sustainAmplitude - startAmplitude) + startAmplitude;
-
-				if (dLifeTime > (attackTime + decayTime))
-					dReleaseAmplitude = sustainAmplitude;
-
-				dAmplitude = ((time - timeOff) / releaseTime) * (0.0 - dReleaseAmplitude) + dReleaseAmplitude;
-			}
-
-			// Amplitude should not be negative
-			if (dAmplitude <= 0.000)
-				dAmplitude = 0.0;
-
-			return dAmplitude;
-		}
-	};
-
 	static float scale(const int noteID)
 	{
 		return 256 * pow(1.0594630943592952645618252949463, noteID);
 	}
-
-	static float envelope(const float time, Envelope &env, const float timeOn, const float timeOff)
-	{
-		return env.amplitude(time, timeOn, timeOff);
-	}
-
-	//An abstract struct for other instruments
-	struct Instrument
-	{
-		float volume;
-		std::string name;
-		EnvelopeADSR env;
-		virtual float sound(const float time, Note&n, bool &bNoteFinished) = 0;
-	};
-
-	struct Bell : public Instrument
-	{
-		Bell()
-		{
-			env.attackTime = 0.01;
-			env.decayTime = 1.0;
-			env.sustainAmplitude = 0.0;
-			env.releaseTime = 1.0;
-
-			volume = 1.0;
-			name = "Bell";
-		}
-
-		virtual float sound(const float time, Note&n, bool &noteFinished) override
-		{
-			float amplitude = envelope(time, env, n.on, n.off);
-			if (amplitude <= 0.0) noteFinished = true;
-
-			float sound =
-				+ 1.00 * osc(n.on - time, scale(n.id + 12), Oscillator::SINE, 5.0, 0.001)
-				+ 0.50 * osc(n.on - time, scale(n.id + 24))
-				+ 0.25 * osc(n.on - time, scale(n.id + 36));
-
-			return amplitude * sound * volume;
-		}
-
-	};
-
-	struct Bell8 : public Instrument
-	{
-		Bell8()
-		{
-			env.attackTime = 0.01;
-			env.decayTime = 0.5;
-			env.sustainAmplitude = 0.8;
-			env.releaseTime = 1.0;
-
-			volume = 1.0;
-			name = "Bell 8-bit";
-		}
-
-		virtual float sound(const float time, Note&n, bool &noteFinished) override
-		{
-			float amplitude = envelope(time, env, n.on, n.off);
-			if (amplitude <= 0.0) noteFinished = true;
-
-			float sound =
-				+1.00 * osc(n.on - time, scale(n.id), Oscillator::SQUARE, 5.0, 0.001)
-				+ 0.50 * osc(n.on - time, scale(n.id + 12))
-				+ 0.25 * osc(n.on - time, scale(n.id + 24));
-
-			return amplitude * sound * volume;
-		}
-
-	};
-
-	struct Harmonica : public Instrument
-	{
-		Harmonica()
-		{
-			env.attackTime = 0.05;
-			env.decayTime = 1.0;
-			env.sustainAmplitude = 0.95;
-			env.releaseTime = 0.1;
-
-			volume = 1.0;
-			name = "Harmonica";
-		}
-
-		virtual float sound(const float time, Note&n, bool &noteFinished) override
-		{
-			float amplitude = envelope(time, env, n.on, n.off);
-			if (amplitude <= 0.0) noteFinished = true;
-
-			float sound =
-				//+ 1.0  * synth::osc(n.on - dTime, synth::scale(n.id-12), synth::OSC_SAW_ANA, 5.0, 0.001, 100)
-				+ 1.00 * osc(n.on - time, scale(n.id), Oscillator::SQUARE, 5.0, 0.001)
-				+ 0.50 * osc(n.on - time, scale(n.id + 12), Oscillator::SQUARE)
-				+ 0.05  * osc(n.on - time, scale(n.id + 24), Oscillator::NOISE);
-
-			return amplitude * sound * volume;
-		}
-
-	};
-
-	struct SawAnalog : public Instrument
-	{
-		SawAnalog()
-		{
-			env.attackTime = 0.05;
-			env.decayTime = 1.0;
-			env.sustainAmplitude = 0.95;
-			env.releaseTime = 0.1;
-
-			volume = 1.0;
-			name = "Analog Saw";
-		}
-
-		virtual float sound(const float time, Note&n, bool &noteFinished) override
-		{
-			float amplitude = envelope(time, env, n.on, n.off);
-			if (amplitude <= 0.0) noteFinished = true;
-
-			float sound =
-				+ 1.00 * osc(n.on - time, scale(n.id), Oscillator::SAW_ANALOG, 5.0, 0.001);
-
-			return amplitude * sound * volume;
-		}
-
-	};
 };
 
 int main()
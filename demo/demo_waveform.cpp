@@ -31,7 +31,7 @@ public:
         for (Note&note : notes)
         {
             // When calling CreateWaveform, you'll be given a unique ID used in all other Waveform functions. Store it somewhere.
-            note.waveformId = ma.CreateWaveform(amplitude, note.frequency, selectedWaveform);
+            note.waveformId = ma.CreateWaveform(amplitude, note.frequency, selectedWaveform, bandLimited);
         }
 
         return true;
@@ -49,6 +49,10 @@ public:
         {
             selectedWaveform = ma_waveform_type((selectedWaveform+1)%4);
         }
+        if(GetKey(olc::W).bPressed)
+        {
+            bandLimited = !bandLimited;
+        }
         if(GetKey(olc::UP).bPressed)
         {
             amplitude = std::min(1.f, amplitude + 0.1f);
@@ -74,6 +78,7 @@ public:
             }
             ma.SetWaveformType(note.waveformId, selectedWaveform);
             ma.SetWaveformAmplitude(note.waveformId, amplitude);
+            ma.SetWaveformBandLimited(note.waveformId, bandLimited);
         }
         
         if(keyPressed)
@@ -86,13 +91,14 @@ public:
         std::stringstream s;
         s << std::fixed << std::setprecision(1) << amplitude;
         DrawStringDecal({0,8}, "Amplitude < " + s.str() + " >   UP, DOWN");
+        DrawStringDecal({0,16}, std::string{"Band Limited < "} + (bandLimited ? "ON" : "OFF") + " >   W");
         
-        for (float drawY{24}; Note&note : notes)
+        for (float drawY{32}; Note&note : notes)
         {
             if(!ma.IsWaveformPlaying(note.waveformId))
                 continue;
 
-            if(drawY == 24)
+            if(drawY == 32)
                 DrawStringDecal({0.f, drawY - 8.f},"Playing: ");
 
             std::stringstream notePlayingStr;
@@ -127,6 +133,7 @@ public:
 
     ma_waveform_type selectedWaveform{ma_waveform_type_sine};
     float amplitude{0.1f};
+    bool bandLimited{false};
 
     struct Note
     {
@@ -62,11 +62,19 @@
 
 #include "miniaudio.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <deque>
 #include <exception>
 #include <filesystem>
 #include <format>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <source_location>
 #include <string>
 #include <unordered_map>
@@ -83,89 +91,620 @@ namespace olc
         std::string name = "olcPGEX_MiniAudio v2.0";
     
     public: // structs
-        struct SoundFileBuffer
+        // how the audio device is set up, hand it to the constructor
+        struct Config
         {
-            SoundFileBuffer();
-            SoundFileBuffer(ma_engine* engine);
-            ~SoundFileBuffer();
+            // the format handed to the device, everything is mixed in f32 regardless
+            ma_format format = ma_format_f32;
+            // 1 is mono, 2 is stereo, 0 uses the device's native channel count
+            ma_uint32 channels = 2;
+            // 0 uses the device's native rate, which saves the OS from resampling
+            ma_uint32 sampleRate = 48000;
+            // 0 lets the backend choose the size and number of periods
+            ma_uint32 periodSizeInFrames = 0;
+            ma_uint32 periods = 0;
+            // the most waveforms which can be loaded at the same time
+            int maxWaveforms = MAX_WAVEFORMS;
+            // the size of the synth's voice pool, the most notes sounding at once
+            int maxVoices = MAX_VOICES;
+            // asks for the smallest stable buffer, two periods unless periods says otherwise
+            bool lowLatency = false;
+            // asks for exclusive use of the device, falls back to shared if it's refused
+            bool exclusive = false;
+            /**
+             * no device at all, nothing plays until Render is called and
+             * it runs as fast as it can. an olc::PixelGameEngine must still
+             * exist, every PGEX registers with one, but it needn't be
+             * constructed or started. without a running one, call
+             * OnBeforeUserUpdate yourself now and then, it's where
+             * finished sounds and loads get tidied up.
+             */
+            bool offline = false;
+        };
 
-            bool Load(const std::string& path, olc::ResourcePack* pack = nullptr);
-            void Unload();
+        // what data_callback has cost so far, see GetAudioStats
+        struct AudioStats
+        {
+            ma_uint64 callbacks = 0;
+            ma_uint64 framesProcessed = 0;
+            // wall time spent in a callback, p99 is approximate, to within about a fifth
+            float minMicroseconds = 0.0f;
+            float averageMicroseconds = 0.0f;
+            float maxMicroseconds = 0.0f;
+            float p99Microseconds = 0.0f;
+            // time spent in a callback over the time its audio lasts, past 1.0f it fell behind
+            float dspLoad = 0.0f;
+            float averageDspLoad = 0.0f;
+            float maxDspLoad = 0.0f;
+            // callbacks which took longer than the audio they produced
+            ma_uint64 lateCallbacks = 0;
+        };
 
-            std::vector<char> m_buffer;
-            int m_count = 0;
-            ma_engine* m_engine;
-            bool m_loaded = false;
-            std::string m_path;
+        // how far behind the mixer the speakers are, see GetOutputLatency
+        struct Latency
+        {
+            // what the device was set up with, every period queued ahead of the output plus resampling
+            ma_uint32 configuredFrames = 0;
+            float configuredMilliseconds = 0.0f;
+            // the same estimate, with the largest buffer a callback has been asked to fill in place of the period
+            ma_uint32 estimatedFrames = 0;
+            float estimatedMilliseconds = 0.0f;
+            // measured, the longest the device has gone between two callbacks so far
+            float callbackIntervalMilliseconds = 0.0f;
         };
-        
+
+        // how LoadSound brings a sound into memory
+        enum class LoadMode
+        {
+            // stream files at least as big as the stream threshold, decode the rest
+            Auto,
+            // decode the whole sound up front, the cheapest to play and seek
+            Decode,
+            // decode a page at a time as it plays, for long music tracks
+            Stream
+        };
+
         struct Sound
         {
             ma_sound m_sound;
             ma_uint64 m_length_in_pcm_frames = 0;
             float m_length_in_seconds = 0;
+            // the lengths are only asked for once the sound has finished loading
+            bool m_length_known = false;
             std::string m_path;
             bool m_play_once = false;
+            // decoded on the fly from disk rather than held fully decoded
+            bool m_streamed = false;
+            // the olc::ResourcePack it was read from, if any
+            olc::ResourcePack* m_pack = nullptr;
+            // the bus it feeds into
+            int m_bus = MASTER_BUS;
+            
+            /**
+             * set while the decoded data has been evicted to stay within
+             * the decoded cache budget. the sound's state is kept here
+             * and it's decoded again the next time it's played.
+             */
+            bool m_evicted = false;
+            float m_saved_volume = 1.0f;
+            float m_saved_pan = 0.0f;
+            float m_saved_pitch = 1.0f;
+            bool m_saved_looping = false;
+            ma_vec3f m_saved_position{0.0f, 0.0f, 0.0f};
+            ma_uint64 m_saved_cursor = 0;
+            ma_uint64 m_saved_stop_frame = ~static_cast<ma_uint64>(0);
+            
+            // slot bookkeeping, the generation is bumped every time the slot is freed
+            int m_generation = 0;
+            bool m_in_use = false;
+            
+            // who to tell when a play once sound reaches its end
+            MiniAudio* m_owner = nullptr;
+            int m_id = -1;
             
             const std::string string();
         };
 
-        class Waveform
+        // a group of sounds loaded together by LoadSoundsAsync
+        struct LoadBatch
         {
-        public:
-            Waveform();
-            Waveform(const double amplitude, const double frequency, const ma_waveform_type waveformType);
-            
-            void Start();
-            void Stop();
-            void Unload();
+            std::vector<int> m_sounds;
+            // signalled by the resource manager once every sound is loaded, must not move
+            std::unique_ptr<ma_fence> m_fence;
+            bool m_in_use = false;
+        };
 
-            bool IsPlaying() const;
-            bool IsLoaded();
-        
-            ma_waveform* Get();
+        /**
+         * a sound loaded once with a fixed number of voices, every
+         * voice shares the same decoded data. firing it just picks
+         * the next voice, nothing is loaded or allocated.
+         */
+        struct SoundBank
+        {
+            std::unique_ptr<ma_sound[]> m_voices;
+            int m_voice_count = 0;
+            int m_next_voice = 0;
+            std::string m_path;
+            bool m_packed = false;
+            // the bus every voice feeds into
+            int m_bus = MASTER_BUS;
+            bool m_loaded = false;
+        };
+
+        /**
+         * a mix bus, a sound group in the engine's node graph. sounds
+         * and other buses feed into it, and it feeds into its parent,
+         * so the engine mixes them hierarchically.
+         */
+        struct Bus
+        {
+            ma_sound_group m_group;
+            int m_parent = MASTER_BUS;
+            bool m_in_use = false;
+        };
+
+        /**
+         * the vectorized loops the mixer is built from.
+         * 
+         * every kernel has a scalar version and, where the platform
+         * has one, an SSE2, AVX2, NEON or wasm SIMD version. SSE2,
+         * NEON and wasm SIMD are picked at compile time, AVX2 is
+         * checked for at runtime. they're public so they can be
+         * benchmarked against each other.
+         */
+        struct Kernels
+        {
+            enum class Path
+            {
+                Scalar,
+                SSE2,
+                AVX2,
+                NEON,
+                WasmSIMD,
+            };
+
+            // the fastest path this machine supports
+            static Path Best();
+            // whether this build, on this machine, can run the given path
+            static bool IsSupported(const Path path);
+            static const char* Name(const Path path);
+
+            // dst[i] += src[i]
+            static void MixAdd(float* dst, const float* src, const size_t count, const Path path);
+            // dst[i] += src[i] * gain
+            static void MixAddGain(float* dst, const float* src, const float gain, const size_t count, const Path path);
+            // dst[i] = clamp(dst[i], -1.0f, 1.0f)
+            static void Clamp(float* dst, const size_t count, const Path path);
+        };
+
+        /**
+         * every waveform's oscillator, as a structure of arrays.
+         * 
+         * the oscillators are kept packed, playing ones first and then
+         * the loaded but stopped ones, so the mixer only walks the ones
+         * playing and reads each field contiguously. starting, stopping
+         * and unloading swap an oscillator into place, all O(1).
+         * 
+         * phases are 32 bit fixed point fractions of a cycle, they wrap
+         * on their own and need no floor() in the loops.
+         * 
+         * audio thread only, sized up front so it never reallocates.
+         */
+        class OscillatorBank
+        {
+        public:
+            void Resize(const int capacity);
+            int Capacity() const;
+
+            void Load(const int id, const double amplitude, const double frequency, const ma_waveform_type type, const bool bandLimited, const ma_uint32 sampleRate);
+            void Unload(const int id);
+            void Start(const int id);
+            void Stop(const int id);
+            void SetAmplitude(const int id, const double amplitude);
+            void SetFrequency(const int id, const double frequency, const ma_uint32 sampleRate);
+            void SetType(const int id, const ma_waveform_type type);
+            void SetBandLimited(const int id, const bool bandLimited);
+
+            // starts or stops an oscillator once Render reaches an engine frame
+            void Schedule(const int id, const ma_uint64 frame, const bool start);
+            // forgets the starts and stops scheduled for an oscillator
+            void ClearSchedule(const int id);
+            /**
+             * adds every playing oscillator into an interleaved buffer, the
+             * same on every channel, mixing with the given kernels. clock
+             * is the engine frame the buffer starts at, scheduled starts
+             * and stops land on their frame.
+             */
+            void Render(float* pOutput, const ma_uint32 frameCount, const ma_uint32 channels, const ma_uint64 clock, const Kernels::Path path);
+            // the number of oscillators playing
+            int Playing() const;
+            // whether any starts or stops are still to come
+            bool HasScheduled() const;
+
+            // adds frameCount frames of one oscillator into a mono buffer, returns the phase it ends on
+            static ma_uint32 Accumulate(float* pOutput, const ma_uint32 frameCount, const ma_uint32 phase, const ma_uint32 increment, const float amplitude, const ma_waveform_type type, const bool bandLimited);
+            // a frequency as a fixed point phase step per frame
+            static ma_uint32 PhaseIncrement(const double frequency, const ma_uint32 sampleRate);
 
         private:
+            // frames rendered per oscillator at a time, small enough to stay in L1
+            static constexpr ma_uint32 TILE_FRAMES = 256;
+
+            // a start or stop of an oscillator, waiting for its frame
+            struct ScheduledEvent
+            {
+                ma_uint64 m_frame = 0;
+                int m_id = 0;
+                bool m_start = false;
+            };
+
+            // renders the oscillators playing right now, no scheduling
+            void render_playing(float* pOutput, const ma_uint32 frameCount, const ma_uint32 channels, const Kernels::Path path);
+            void swap_slots(const int a, const int b);
+            // the polyBLEP residual of a step at phase 0, non-zero within a frame either side
+            static float poly_blep(const ma_uint32 phase, const ma_uint32 increment);
+            // the polyBLAMP residual of a corner at phase 0, the integral of poly_blep
+            static float poly_blamp(const ma_uint32 phase, const ma_uint32 increment);
+
+            // packed, [0, m_playing) are playing, [m_playing, m_loaded) are stopped
+            std::vector<ma_uint32> m_phase;
+            std::vector<ma_uint32> m_increment;
+            std::vector<float> m_amplitude;
+            std::vector<ma_waveform_type> m_type;
+            std::vector<ma_uint8> m_band_limited;
+            // the waveform id in each packed slot, and each waveform id's packed slot or -1
+            std::vector<int> m_ids;
+            std::vector<int> m_slots;
+            int m_playing = 0;
+            int m_loaded = 0;
+            std::array<float, TILE_FRAMES> m_tile{};
+            // in the order they were scheduled, reserved up front
+            std::vector<ScheduledEvent> m_schedule;
+        };
+
+        // what the game thread knows about a waveform, mirrors what it sent to the audio thread
+        struct WaveformInfo
+        {
+            double m_amplitude = 0.0;
+            double m_frequency = 0.0;
+            ma_waveform_type m_type = ma_waveform_type_sine;
+            bool m_band_limited = false;
             bool m_is_playing = false;
-            bool m_is_loaded  = false;
-            
-            ma_waveform m_waveform;
-            ma_waveform_config m_waveform_config;
+            bool m_is_loaded = false;
+            // set once a start or stop has been scheduled, until PlayWaveform or StopWaveform
+            bool m_is_scheduled = false;
+        };
+
+        /**
+         * how a synth note's loudness moves over its life. the times
+         * are in seconds, sustain is a level, 0.0f to 1.0f.
+         */
+        struct Envelope
+        {
+            float attack = 0.01f;
+            float decay = 0.1f;
+            float sustain = 1.0f;
+            float release = 0.2f;
+        };
+
+        // one oscillator of an instrument, pitched in semitones from the note played
+        struct Partial
+        {
+            ma_waveform_type type = ma_waveform_type_sine;
+            float semitones = 0.0f;
+            // 0.0f leaves the partial out
+            float amplitude = 0.0f;
+            bool bandLimited = false;
+        };
+
+        /**
+         * what a synth note sounds like. its partials and noise are
+         * summed, share one vibrato and are shaped by the envelope.
+         */
+        struct Instrument
+        {
+            static constexpr int MAX_PARTIALS = 4;
+
+            std::array<Partial, MAX_PARTIALS> partials{Partial{ma_waveform_type_sine, 0.0f, 1.0f}};
+            // white noise, mixed in with the partials
+            float noise = 0.0f;
+            float vibratoHertz = 0.0f;
+            float vibratoSemitones = 0.0f;
+            Envelope envelope;
+            // 0.0f is mute, 1.0f is full
+            float volume = 1.0f;
+            // -1.0f is left, 1.0f is right, 0.0f is center
+            float pan = 0.0f;
+        };
+
+        /**
+         * the synth's voices, one fixed pool shared by every instrument.
+         * 
+         * like the oscillator bank, the sounding voices are kept packed
+         * at the front, so a block only costs the notes still sounding.
+         * once every voice is busy a new note steals one, the quietest
+         * releasing voice, or failing that the oldest.
+         * 
+         * audio thread only, sized up front so it never reallocates.
+         */
+        class Synth
+        {
+        public:
+            void Resize(const int voices, const int instruments, const ma_uint32 sampleRate);
+            int InstrumentCapacity() const;
+
+            void SetInstrument(const int id, const Instrument& instrument);
+            // cuts off every voice playing the instrument
+            void UnloadInstrument(const int id);
+            void NoteOn(const int note, const int instrument, const float frequency, const float velocity);
+            void NoteOff(const int note);
+            void AllNotesOff();
+            // voices sounding, releasing ones included
+            int ActiveVoices() const;
+
+            // adds every sounding voice into an interleaved buffer, mixing with the given kernels
+            void Render(float* pOutput, const ma_uint32 frameCount, const ma_uint32 channels, const Kernels::Path path);
+
+        private:
+            static constexpr ma_uint32 TILE_FRAMES = 256;
+
+            enum class Stage
+            {
+                Attack,
+                Decay,
+                Sustain,
+                Release,
+            };
+
+            struct Voice
+            {
+                int m_note = -1;
+                int m_instrument = 0;
+                float m_velocity = 1.0f;
+                // the note's frequency, before each partial's semitones
+                float m_frequency = 0.0f;
+                std::array<ma_uint32, Instrument::MAX_PARTIALS> m_phase{};
+                std::array<ma_uint32, Instrument::MAX_PARTIALS> m_increment{};
+                ma_uint32 m_vibrato_phase = 0;
+                ma_uint32 m_noise_state = 1;
+                Stage m_stage = Stage::Attack;
+                float m_level = 0.0f;
+                float m_release_step = 0.0f;
+                // when the note started, the oldest is stolen first
+                ma_uint64 m_started = 0;
+            };
+
+            // the voice to play a new note on, a stolen one if none are free
+            int claim_voice();
+            void release_voice(Voice& voice);
+            void free_voice(const int index);
+            // works out a voice's partial increments from its frequency and its instrument
+            void tune_voice(Voice& voice);
+            // renders one voice into m_voice_tile, returns false once its envelope has finished
+            bool render_voice(Voice& voice, const ma_uint32 frames);
+
+            // packed, [0, m_active) are sounding
+            std::vector<Voice> m_voices;
+            int m_active = 0;
+            std::vector<Instrument> m_instruments;
+            ma_uint32 m_sample_rate = 48000;
+            ma_uint64 m_note_clock = 0;
+            std::array<float, TILE_FRAMES> m_voice_tile{};
+            std::array<float, TILE_FRAMES> m_left{};
+            std::array<float, TILE_FRAMES> m_right{};
+        };
+
+        /**
+         * a node in the engine's graph which makes its own sound. the
+         * waveforms, the synth and the noise callback each have one, so
+         * they're mixed in the same pass as sounds and can be routed
+         * through buses and effects.
+         * 
+         * the node base must come first, miniaudio reads it straight
+         * through the ma_node pointer.
+         */
+        struct GeneratorNode
+        {
+            ma_node_base m_base;
+            MiniAudio* m_owner = nullptr;
+            // the bus it feeds into, game thread
+            int m_bus = MASTER_BUS;
+            // audio thread, the engine frame the next frame it makes will play at
+            ma_uint64 m_clock = 0;
+        };
+
+        // what the game thread knows about an instrument
+        struct InstrumentInfo
+        {
+            Instrument m_instrument;
+            bool m_is_loaded = false;
+        };
+
+        using NoiseBlockCallback = std::function<void(float* noiseData, const ma_uint32 frameCount, const ma_uint32 channels, const ma_uint64 frameClock)>;
+
+        // a request from the game thread, carried out by the audio thread at the start of its next callback
+        struct Command
+        {
+            enum class Type
+            {
+                CreateWaveform,
+                PlayWaveform,
+                StopWaveform,
+                PlayWaveformAt,
+                StopWaveformAt,
+                SetWaveformAmplitude,
+                SetWaveformFrequency,
+                SetWaveformType,
+                SetWaveformBandLimited,
+                UnloadWaveform,
+                SetNoiseCallback,
+                SetInstrument,
+                UnloadInstrument,
+                NoteOn,
+                NoteOff,
+                AllNotesOff,
+            };
+
+            Type m_type = Type::CreateWaveform;
+            int m_id = 0;
+            double m_amplitude = 0.0;
+            double m_frequency = 0.0;
+            ma_waveform_type m_waveform_type = ma_waveform_type_sine;
+            bool m_band_limited = false;
+            NoiseBlockCallback* m_noise_callback = nullptr;
+            int m_instrument_id = 0;
+            Instrument* m_instrument = nullptr;
+            // the engine frame a scheduled command lands on
+            ma_uint64 m_frame = 0;
+        };
+
+        /**
+         * a fixed size, single producer, single consumer ring buffer.
+         * 
+         * one thread may Push and one other thread may Pop, neither
+         * of them ever blocks or allocates.
+         */
+        template<typename T>
+        class LockFreeQueue
+        {
+        public:
+            LockFreeQueue(const size_t capacity)
+            {
+                size_t size = 1;
+                while(size < capacity + 1)
+                    size <<= 1;
+
+                m_items.resize(size);
+                m_mask = size - 1;
+            }
+
+            bool Push(const T& item)
+            {
+                const size_t head = m_head.load(std::memory_order_relaxed);
+                const size_t next = (head + 1) & m_mask;
+
+                if(next == m_tail.load(std::memory_order_acquire))
+                    return false;
+
+                m_items[head] = item;
+                m_head.store(next, std::memory_order_release);
+                return true;
+            }
+
+            bool Pop(T& item)
+            {
+                const size_t tail = m_tail.load(std::memory_order_relaxed);
+
+                if(tail == m_head.load(std::memory_order_acquire))
+                    return false;
+
+                item = m_items[tail];
+                m_tail.store((tail + 1) & m_mask, std::memory_order_release);
+                return true;
+            }
+
+        private:
+            std::vector<T> m_items;
+            size_t m_mask = 0;
+            alignas(64) std::atomic<size_t> m_head{0};
+            alignas(64) std::atomic<size_t> m_tail{0};
         };
 
     public:
         MiniAudio();
+        explicit MiniAudio(const Config& config);
         ~MiniAudio();
         virtual bool OnBeforeUserUpdate(float& fElapsedTime) override;
         static void data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount);
-        static std::vector<MiniAudio::Waveform> m_waveforms;
 
     public: // static variables
         static bool m_background_playback;
-        static std::vector<float> m_engine_buffer;
-        static std::vector<float> m_waveform_buffer;
-        static std::function<void(float& out_data_channel_left, float& out_data_channel_right, const float fElapsedTime)> m_noise_callback;
-        static float m_noise_left_channel;
-        static float m_noise_right_channel;
+
+    public: // limits
+        // the default for the most waveforms which can be loaded at the same time, see Config
+        static constexpr int MAX_WAVEFORMS = 1024;
+        // the default size of the synth's voice pool, see Config
+        static constexpr int MAX_VOICES = 64;
+        // the most synth instruments which can be created at the same time
+        static constexpr int MAX_INSTRUMENTS = 64;
+        // the most commands which can be waiting for the audio thread
+        static constexpr int MAX_PENDING_COMMANDS = 4096;
+        // the most waveform starts and stops which can be scheduled ahead at once
+        static constexpr int MAX_SCHEDULED_EVENTS = 4096;
+        // bounds for the size of the mix buffers, in frames
+        static constexpr ma_uint32 MIN_MIX_BUFFER_FRAMES = 512;
+        static constexpr ma_uint32 MAX_MIX_BUFFER_FRAMES = 8192;
 
     public: // configuration
         void SetBackgroundPlay(const bool state);
+        /**
+         * files of at least this many bytes loaded with LoadMode::Auto are
+         * streamed, 0 (the default) never streams on its own.
+         * 
+         * a stream holds two pages of one second each, decoded to f32 at the
+         * engine's channels and sample rate, plus the decoder's own state.
+         * at 48kHz stereo that's 2 * 48000 * 2 * 4 bytes, about 750KiB, no
+         * matter how long the track is. decoded in full the same track costs
+         * about 375KiB for every second of it.
+         */
+        void SetStreamThreshold(const std::uintmax_t bytes);
+        /**
+         * caps the memory held by decoded sounds, in bytes, 0 (the default)
+         * is no limit. over it, the sounds nobody is playing are evicted,
+         * least recently played first, and decoded again the next time
+         * they're played. sound banks and streams are never evicted.
+         */
+        void SetDecodedCacheBudget(const size_t bytes);
+        // the memory held by decoded sounds right now, in bytes
+        size_t GetDecodedCacheSize();
 
     public: // loading routines
-        const int LoadSound(const std::string& path, olc::ResourcePack* pack = nullptr, bool playOnce = false);
+        const int LoadSound(const std::string& path, olc::ResourcePack* pack = nullptr, bool playOnce = false, const LoadMode mode = LoadMode::Auto, const int bus = MASTER_BUS);
         void UnloadSound(const int id);
+        // loads a sound with the given number of voices, for one-offs fired often. returns a sound bank id
+        const int LoadSoundBank(const std::string& path, const int voices, olc::ResourcePack* pack = nullptr, const int bus = MASTER_BUS);
+        void UnloadSoundBank(const int id);
+        /**
+         * starts loading every sound in the list and returns straight away,
+         * the decoding happens on the resource manager's job threads.
+         * returns a batch id, to follow the progress of the batch with.
+         * 
+         * the sounds can be played before they've finished, they start
+         * once enough of them is decoded.
+         */
+        const int LoadSoundsAsync(const std::vector<std::string>& paths, olc::ResourcePack* pack = nullptr, const LoadMode mode = LoadMode::Auto, const int bus = MASTER_BUS);
+        // how much of a batch has finished loading, 0.0f to 1.0f
+        float GetLoadProgress(const int batchId);
+        // whether every sound of a batch has finished loading
+        bool IsLoadComplete(const int batchId);
+        // blocks until every sound of a batch has finished loading, on Emscripten by doing the loading itself
+        void WaitForLoad(const int batchId);
+        // the sound ids of a batch, in the same order as the paths given to LoadSoundsAsync
+        const std::vector<int>& GetBatchSounds(const int batchId);
+        // forgets about a batch, waiting for it to finish first. its sounds stay loaded
+        void ReleaseBatch(const int batchId);
     
     public: // playback routines
         // plays a sample, can be set to loop
         void Play(const int id, const bool looping = false);
         // plays a sound file, as a one off, and automatically unloads it
-        const int Play(const std::string& path, olc::ResourcePack* pack = nullptr);
+        const int Play(const std::string& path, olc::ResourcePack* pack = nullptr, const int bus = MASTER_BUS);
+        // plays the next voice of a sound bank, the oldest voice is restarted if they're all busy
+        void PlaySoundBank(const int id, const float volume = 1.0f, const float pan = 0.0f, const float pitch = 1.0f);
         // stops a sample, rewinds to beginning
         void Stop(const int id);
         // pauses a sample, does not change position
         void Pause(const int id);
         // toggle between play and pause
         void Toggle(const int id);
+        /**
+         * plays a sample once the engine reaches a frame, to the frame.
+         * see GetEngineTimeInFrames, and schedule far enough ahead that
+         * the sound has finished loading by then.
+         */
+        void PlayAt(const int id, const ma_uint64 engineFrame, const bool looping = false);
+        // stops a sample once the engine reaches a frame, it keeps its position like Pause does
+        void StopAt(const int id, const ma_uint64 engineFrame);
 
     public: // seeking controls
         // seek to the provided position in the sound, by milliseconds
@@ -195,23 +734,67 @@ namespace olc
         // get the current number of active "one off" sounds 
         int GetOneOffCount();
 
+    public: // mix buses
+        // the engine's output, every bus and sound feeds into it in the end
+        static constexpr int MASTER_BUS = -1;
+        // creates a bus feeding into parent, buses can be nested. returns a bus id
+        const int CreateBus(const int parent = MASTER_BUS);
+        // unloads a bus, whatever fed into it feeds into its parent instead
+        void UnloadBus(const int id);
+        // routes a sound into a bus, MASTER_BUS to take it out of every bus
+        void SetSoundBus(const int soundId, const int busId);
+        // routes every waveform into a bus, MASTER_BUS to take them out of every bus
+        void SetWaveformBus(const int busId);
+        // routes every synth voice into a bus, MASTER_BUS to take them out of every bus
+        void SetSynthBus(const int busId);
+        // routes the noise callback into a bus, MASTER_BUS to take it out of every bus
+        void SetNoiseBus(const int busId);
+        // set volume of a bus, 0.0f is mute, 1.0f is full
+        void SetBusVolume(const int id, const float& volume);
+        // set pan of a bus, -1.0f is left, 1.0f is right, 0.0f is center
+        void SetBusPan(const int id, const float& pan);
+        // set pitch of a bus, 1.0f is normal
+        void SetBusPitch(const int id, const float& pitch);
+        // pauses everything feeding into a bus, nothing loses its position
+        void PauseBus(const int id);
+        void ResumeBus(const int id);
+        bool IsBusPaused(const int id);
+        // ADVANCED USAGE, retrieval of a bus's raw ma_sound_group
+        ma_sound_group* GetBus(const int id);
+
     public: // waveforms
-        // creates a new waveform and returns the id of the waveform
-        const int CreateWaveform(const double amplitude, const double frequency, const ma_waveform_type waveformType);
-        // starts playing a waveform, continues producing sound until stopped
+        /**
+         * creates a new waveform and returns the id of the waveform.
+         * 
+         * band limited square, sawtooth and triangle waves have their
+         * corners smoothed (polyBLEP) so they don't alias at high notes,
+         * for a little more work. sine waves are band limited already.
+         */
+        const int CreateWaveform(const double amplitude, const double frequency, const ma_waveform_type waveformType, const bool bandLimited = false);
+        // starts playing a waveform, continues producing sound until stopped, cancels anything scheduled for it
         void PlayWaveform(const int id);
+        /**
+         * starts playing a waveform once the engine reaches a frame, to
+         * the sample. up to MAX_SCHEDULED_EVENTS starts and stops can be
+         * waiting at once, any more take effect straight away.
+         */
+        void PlayWaveformAt(const int id, const ma_uint64 engineFrame);
+        // stops a waveform once the engine reaches a frame, to the sample
+        void StopWaveformAt(const int id, const ma_uint64 engineFrame);
         // change the amplitude of a waveform (loudness)
         void SetWaveformAmplitude(const int id, const double amplitude);
         // change the frequency of a waveform (pitch)
         void SetWaveformFrequency(const int id, const double frequency);
         // change the type of a waveform
         void SetWaveformType(const int id, const ma_waveform_type waveformType);
-        // stop a waveform from playing
+        // switch band limiting of a waveform on or off
+        void SetWaveformBandLimited(const int id, const bool bandLimited);
+        // stop a waveform from playing, cancels anything scheduled for it
         void StopWaveform(const int id);
         // unload and free resources of a given waveform
         void UnloadWaveform(const int id);
 
-        // whether or not a waveform is currently playing
+        // whether or not a waveform is currently playing, or will be after the last start or stop scheduled
         const bool IsWaveformPlaying(const int id);
         // returns waveform amplitude
         const double& GetWaveformAmplitude(const int id);
@@ -219,9 +802,34 @@ namespace olc
         const double& GetWaveformFrequency(const int id);
         // returns waveform type
         const ma_waveform_type& GetWaveformType(const int id);
-        // ADVANCED USAGE, retrieval of raw ma_waveform object
-        ma_waveform* GetWaveform(const int id);
+        // whether a waveform is band limited
+        const bool IsWaveformBandLimited(const int id);
     
+    public: // synthesizer
+        // creates an instrument for the synth to play notes on, returns the id of the instrument
+        const int CreateInstrument(const Instrument& instrument);
+        // changes an instrument, notes already sounding on it change too
+        void SetInstrument(const int id, const Instrument& instrument);
+        // unloads an instrument, cutting off every note playing on it
+        void UnloadInstrument(const int id);
+        // returns an instrument, as it was last set
+        const Instrument& GetInstrument(const int id);
+        /**
+         * starts a note on an instrument and returns the id of the note.
+         * 
+         * notes are rendered a block at a time by a fixed pool of voices,
+         * Config::maxVoices of them. when they're all busy, the quietest
+         * releasing voice, or else the oldest, is stolen for the new note
+         * and NoteOff on the note it was playing does nothing.
+         */
+        const int NoteOn(const int instrument, const float frequency, const float velocity = 1.0f);
+        // releases a note, it fades out over its instrument's release time
+        void NoteOff(const int note);
+        // releases every note
+        void AllNotesOff();
+        // the number of voices sounding, as of the last callback
+        int GetActiveVoiceCount();
+
     public: // noise generation
         
         /**
@@ -239,19 +847,245 @@ namespace olc
          * 
          * if you do not change the output channels, the values
          * previously used wil be played.
+         * 
+         * this is a convenience wrapper around SetNoiseBlockCallback,
+         * prefer that one for anything more than a few oscillators.
          */
         void SetNoiseCallback(std::function<void(float& noiseLeftChannel, float& noiseRightChannel, const float fElapsedTime)>callbackFunc);
+        
+        /**
+         * set a block based noise callback function so your application
+         * can send a whole buffer of sound at a time.
+         * 
+         * the callback provides an interleaved buffer of frameCount
+         * frames, each frame holding one sample per channel. it is
+         * silent when handed to you, fill it with raw audio data.
+         * 
+         * for periodic functions, frameClock is the absolute index of
+         * the first frame in the buffer. divide it by the sample rate
+         * to get the total audio time.
+         */
+        void SetNoiseBlockCallback(std::function<void(float* noiseData, const ma_uint32 frameCount, const ma_uint32 channels, const ma_uint64 frameClock)>callbackFunc);
         // clears the noise callback and resets the channel values to 0.0
         void ClearNoiseCallback();
 
     public: // advanced features
+        // the config the device ended up with, native values filled in
+        const Config& GetConfig();
+        // the engine's clock, the frames it has mixed so far, what PlayAt and PlayWaveformAt schedule against
+        ma_uint64 GetEngineTimeInFrames();
+        // the latency from the mixer to the output, estimated from the device, plus the callback interval measured
+        Latency GetOutputLatency();
+        /**
+         * offline only, mixes the next frameCount frames into pOutput,
+         * interleaved f32, through the same path as the audio callback.
+         * focus and background play don't apply.
+         */
+        void Render(float* pOutput, const ma_uint64 frameCount);
+        // a snapshot of the callback's timings, cheap enough to take every frame
+        AudioStats GetAudioStats();
+        // starts the callback's timings over, from the next callback on
+        void ResetAudioStats();
         ma_device* GetDevice();
         ma_engine* GetEngine();
         ma_resource_manager* GetResourceManager();
         ma_sound* GetSound(const int id);
+        // the nodes the waveforms, the synth and the noise callback are played through, to attach effects to
+        ma_node* GetWaveformNode();
+        ma_node* GetSynthNode();
+        ma_node* GetNoiseNode();
 
     private:
-        const int find_or_create_empty_sound_slot();
+        /**
+         * sound ids are handles, the low bits index the slot in
+         * m_sounds and the high bits carry the slot's generation.
+         * an id kept after its sound was unloaded no longer matches
+         * the slot's generation, and is rejected.
+         */
+        static constexpr int SOUND_INDEX_BITS = 20;
+        static constexpr int SOUND_INDEX_MASK = (1 << SOUND_INDEX_BITS) - 1;
+        static constexpr int SOUND_GENERATION_MASK = (1 << (31 - SOUND_INDEX_BITS)) - 1;
+
+        /**
+         * the callback's timings. only the audio thread writes them, so
+         * plain relaxed loads and stores are enough, a snapshot might
+         * straddle a callback but never sees a torn value.
+         * 
+         * timings also land in a histogram of four buckets per power of
+         * two nanoseconds, which is what p99 is read from.
+         */
+        struct CallbackStats
+        {
+            static constexpr int BUCKETS = 160;
+
+            std::atomic<ma_uint64> m_callbacks{0};
+            std::atomic<ma_uint64> m_frames{0};
+            std::atomic<ma_uint64> m_total_ns{0};
+            std::atomic<ma_uint64> m_total_budget_ns{0};
+            std::atomic<ma_uint64> m_min_ns{0};
+            std::atomic<ma_uint64> m_max_ns{0};
+            std::atomic<float> m_load{0.0f};
+            std::atomic<float> m_max_load{0.0f};
+            std::atomic<ma_uint64> m_late{0};
+            std::array<std::atomic<ma_uint32>, BUCKETS> m_histogram{};
+            // set by the game thread, the audio thread does the clearing
+            std::atomic<bool> m_reset_requested{false};
+
+            // audio thread
+            void Record(const ma_uint64 ns, const ma_uint32 frames, const ma_uint32 sampleRate);
+            // game thread
+            AudioStats Snapshot() const;
+
+            static int bucket(const ma_uint64 ns);
+            static ma_uint64 bucket_upper_ns(const int bucket);
+        };
+
+        /**
+         * the file system the resource manager reads through. files
+         * loaded from an olc::ResourcePack are served from memory,
+         * files on disk are memory mapped where the platform allows,
+         * anything else goes to miniaudio's default file system.
+         * 
+         * the callbacks must come first, miniaudio reads them straight
+         * through the ma_vfs pointer.
+         */
+        struct PackVFS
+        {
+            ma_vfs_callbacks m_callbacks;
+            MiniAudio* m_owner;
+        };
+
+        // an open file, as the resource manager sees it
+        struct PackFile
+        {
+            std::shared_ptr<const std::vector<char>> m_data;
+            // what reads are served from, m_data or m_mapping
+            const char* m_bytes = nullptr;
+            size_t m_size = 0;
+            size_t m_cursor = 0;
+            std::string m_path;
+            // set when a file on disk could be memory mapped
+            void* m_mapping = nullptr;
+            // set when the file lives on disk and couldn't be mapped
+            ma_vfs_file m_default_file = nullptr;
+        };
+
+        /**
+         * the encoded data of a packed file. it's only read out of the
+         * pack on the game thread, and only held for as long as a
+         * decoder or a stream still needs it. the size outlives the data,
+         * so later Auto loads can pick a mode without reading it again.
+         */
+        struct PackEntry
+        {
+            std::shared_ptr<const std::vector<char>> m_data;
+            size_t m_size = 0;
+            int m_decoded_count = 0;
+            int m_streamed_count = 0;
+        };
+
+        // the decoded data of a path, which the resource manager shares between its sounds
+        struct DecodedEntry
+        {
+            size_t m_bytes = 0;
+            ma_uint64 m_last_played = 0;
+            int m_sound_count = 0;
+            int m_bank_count = 0;
+            // scratch for enforce_decoded_budget
+            bool m_busy = false;
+        };
+
+        // takes a slot from the free list, or grows the pool, returns its id
+        const int allocate_sound_slot();
+        // puts a slot back on the free list, invalidating its id
+        void release_sound_slot(const int id);
+        // the sound for an id, throws if the id is stale or invalid
+        Sound& get_sound(const int id);
+        // whether an id refers to a loaded sound
+        bool is_valid_sound(const int id);
+        // the id for the sound currently in a slot
+        const int sound_id(const int index);
+        // audio thread: a play once sound reached its end, queue it for unloading
+        static void sound_end_callback(void* pUserData, ma_sound* pSound);
+        // game thread: unload a play once sound if it really has finished
+        void reap_sound(const int id);
+        // whether LoadSound should stream this file from disk rather than decode it
+        bool should_stream(const std::string& path, const LoadMode mode);
+        // makes a packed file readable through m_pack_vfs, returns whether to stream it
+        bool acquire_pack_file(const std::string& path, olc::ResourcePack* pack, const LoadMode mode);
+        void release_pack_file(const std::string& path, const bool streamed);
+        // LoadSound, signalling pFence once the sound has finished loading
+        const int load_sound(const std::string& path, olc::ResourcePack* pack, const bool playOnce, const LoadMode mode, ma_fence* pFence, const int bus);
+        // the bus for an id, throws if it isn't in use
+        Bus& get_bus(const int id);
+        // the instrument for an id, throws if it isn't loaded
+        InstrumentInfo& get_instrument(const int id);
+        // sets up a generator node, feeding into the engine's endpoint
+        void init_generator_node(GeneratorNode& node, const ma_node_vtable* vtable);
+        // routes a generator node into a bus
+        void set_generator_bus(GeneratorNode& node, const int busId);
+        // audio thread: the ma_node_vtable callbacks of the generator nodes
+        static void waveform_node_process(ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn, float** ppFramesOut, ma_uint32* pFrameCountOut);
+        static void synth_node_process(ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn, float** ppFramesOut, ma_uint32* pFrameCountOut);
+        static void noise_node_process(ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn, float** ppFramesOut, ma_uint32* pFrameCountOut);
+        // audio thread: stops the generator nodes with nothing to play, so the graph skips them
+        void update_generator_nodes();
+        // the group sounds of a bus are initialized into, nullptr for MASTER_BUS
+        ma_sound_group* bus_group(const int id);
+        // the node a bus's inputs attach to, the engine's endpoint for MASTER_BUS
+        ma_node* bus_node(const int id);
+        // whether a sound has finished loading, doesn't block
+        bool is_sound_loaded(Sound& sound);
+        // whether a sound is waiting for the start time PlayAt gave it
+        bool is_scheduled(Sound& sound);
+        // forgets the start and stop times PlayAt and StopAt gave a sound
+        void clear_schedule(Sound& sound);
+        // caches the lengths of a sound once it has loaded, returns whether they're known
+        bool update_length(Sound& sound);
+        // game thread: picks up the lengths of sounds that finished loading
+        void update_pending_lengths();
+        // the batch for an id, throws if it isn't in use
+        LoadBatch& get_batch(const int batchId);
+        // game thread: blocks until a fence is signalled, doing the resource manager's jobs where it has no threads
+        void wait_for_fence(ma_fence* pFence);
+        // readies a file to be decoded, from a pack or from disk
+        void acquire_sound_file(const std::string& path, olc::ResourcePack* pack);
+        // undoes whatever loading a sound's file took, for either kind of source
+        void release_sound_file(const std::string& path, const bool packed, const bool streamed);
+        // counts decoded data against the decoded cache budget
+        void track_decoded(const std::string& path, const ma_uint64 frames, const bool bank);
+        // fills in the size of a path tracked before its length was known
+        void update_decoded(const std::string& path, const ma_uint64 frames);
+        void untrack_decoded(const std::string& path, const bool bank);
+        // marks a path as just played, for least recently played eviction
+        void touch_decoded(const std::string& path);
+        // game thread: evict idle decoded sounds until within the budget
+        void enforce_decoded_budget();
+        void evict_sound(Sound& sound);
+        void restore_sound(Sound& sound);
+        // the sound for an id, decoded again first if it was evicted
+        Sound& resident_sound(const int id);
+        // the ma_vfs callbacks for m_pack_vfs, called from the resource manager's threads
+        static ma_result vfs_open(ma_vfs* pVFS, const char* pFilePath, ma_uint32 openMode, ma_vfs_file* pFile);
+        static ma_result vfs_open_w(ma_vfs* pVFS, const wchar_t* pFilePath, ma_uint32 openMode, ma_vfs_file* pFile);
+        static ma_result vfs_close(ma_vfs* pVFS, ma_vfs_file file);
+        static ma_result vfs_read(ma_vfs* pVFS, ma_vfs_file file, void* pDst, size_t sizeInBytes, size_t* pBytesRead);
+        static ma_result vfs_write(ma_vfs* pVFS, ma_vfs_file file, const void* pSrc, size_t sizeInBytes, size_t* pBytesWritten);
+        static ma_result vfs_seek(ma_vfs* pVFS, ma_vfs_file file, ma_int64 offset, ma_seek_origin origin);
+        static ma_result vfs_tell(ma_vfs* pVFS, ma_vfs_file file, ma_int64* pCursor);
+        static ma_result vfs_info(ma_vfs* pVFS, ma_vfs_file file, ma_file_info* pInfo);
+        // maps a file on disk read-only into an open PackFile, false where that isn't available
+        static bool map_file(const char* pFilePath, PackFile& file);
+        // game thread: queue a command for the audio thread
+        void send_command(const Command& command);
+        // audio thread: carry out a command sent from the game thread
+        void process_command(const Command& command);
+        // game thread: free what the audio thread has finished with
+        void collect_garbage();
+        // audio thread: everything data_callback does, between taking its timings
+        void process_callback(void* pOutput, const ma_uint32 frameCount);
+        // audio thread: mix up to m_mix_buffer_frames frames into pOutput
+        void mix(void* pOutput, const ma_uint32 frameCount);
 
     private:
         ma_device m_device;
@@ -264,20 +1098,127 @@ namespace olc
         ma_engine_config m_engine_config;
         
         bool m_initialized = false;
+        Config m_config;
+        // the size of a frame handed to the device, in its format
+        ma_uint32 m_output_frame_bytes = 0;
+        // audio thread -> game thread, the largest frameCount seen by data_callback
+        std::atomic<ma_uint32> m_max_callback_frames{0};
+        // audio thread -> game thread, the longest gap between two data_callbacks
+        std::atomic<ma_uint64> m_max_callback_interval_ns{0};
+        // audio thread only, when data_callback last started
+        std::chrono::steady_clock::time_point m_last_callback{};
+        CallbackStats m_callback_stats;
         int m_count_play_once_sounds = 0;
-        std::vector<Sound*> m_sounds;
+        // files this big and up are streamed by LoadMode::Auto, 0 never
+        std::uintmax_t m_stream_threshold = 0;
+        
+        /**
+         * the pool of sounds. a deque never moves its elements when
+         * it grows, which the ma_sound inside each one relies on.
+         */
+        std::deque<Sound> m_sounds;
+        std::vector<int> m_free_sound_slots;
+        
+        std::vector<SoundBank> m_sound_banks;
+
+        // a deque, the node graph holds on to every group's address
+        std::deque<Bus> m_buses;
         
-        std::unordered_map<std::string, SoundFileBuffer> m_sound_file_buffers;
+        std::vector<LoadBatch> m_load_batches;
+        // ids of sounds whose lengths aren't known yet
+        std::vector<int> m_pending_lengths;
+        
+        PackVFS m_pack_vfs;
+        ma_default_vfs m_default_vfs;
+        // guards m_pack_entries, the resource manager opens files from its job threads
+        std::mutex m_pack_mutex;
+        std::unordered_map<std::string, PackEntry> m_pack_entries;
+
+        // the decoded cache, 0 is no budget
+        std::unordered_map<std::string, DecodedEntry> m_decoded_entries;
+        size_t m_decoded_bytes = 0;
+        size_t m_decoded_budget = 0;
+        ma_uint64 m_play_clock = 0;
+
+        /**
+         * game thread state, the only view of the waveforms the game
+         * thread is allowed to touch
+         */
+        std::vector<WaveformInfo> m_waveform_infos;
+        std::vector<InstrumentInfo> m_instrument_infos;
+        // the id the next note gets
+        int m_next_note = 0;
+        
+        /**
+         * audio thread state, only ever touched from inside the
+         * callback once the device has started. sized up front so
+         * it never reallocates underneath the mixer.
+         */
+        OscillatorBank m_oscillators;
+        Synth m_synth;
+        NoiseBlockCallback* m_noise_block_callback = nullptr;
+
+        // nodes in the engine's graph, they must not move once they're initialized
+        GeneratorNode m_waveform_node;
+        GeneratorNode m_synth_node;
+        GeneratorNode m_noise_node;
+
+        /**
+         * mix buffers, sized once when the device is created so the
+         * callback never allocates
+         */
+        ma_uint32 m_mix_buffer_frames = 0;
+        Kernels::Path m_kernel_path = Kernels::Path::Scalar;
+        std::vector<float> m_engine_buffer;
+
+        // game thread -> audio thread
+        LockFreeQueue<Command> m_commands{MAX_PENDING_COMMANDS};
+        // audio thread -> game thread, callbacks to be deleted off the audio thread
+        LockFreeQueue<NoiseBlockCallback*> m_noise_callback_garbage{MAX_PENDING_COMMANDS + 1};
+        // audio thread -> game thread, instruments copied in and to be deleted off the audio thread
+        LockFreeQueue<Instrument*> m_instrument_garbage{MAX_PENDING_COMMANDS + 1};
+        // audio thread -> game thread, voices sounding at the end of the last callback
+        std::atomic<int> m_active_voices{0};
+        // audio thread -> game thread, ids of play once sounds which reached their end
+        LockFreeQueue<int> m_ended_sounds{MAX_PENDING_COMMANDS};
+        // set when m_ended_sounds was full, the game thread falls back to checking every sound
+        std::atomic<bool> m_ended_sounds_overflowed{false};
     };
 }
 
 #ifdef OLC_PGEX_MINIAUDIO
 #undef OLC_PGEX_MINIAUDIO
 
-static constexpr int            DEVICE_CHANNELS     = 2;
-static constexpr ma_format      DEVICE_FORMAT       = ma_format_f32;
-static constexpr int            DEVICE_SAMPLE_RATE  = 48000;
-static constexpr ma_device_type DEVICE_TYPE         = ma_device_type_playback;
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define PGEX_MA_SSE2
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define PGEX_MA_AVX2
+        #define PGEX_MA_TARGET_AVX2
+    #elif defined(__GNUC__) || defined(__clang__)
+        #define PGEX_MA_AVX2
+        #define PGEX_MA_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+    #define PGEX_MA_NEON
+    #include <arm_neon.h>
+#endif
+
+#if defined(__wasm_simd128__)
+    #define PGEX_MA_WASM_SIMD
+    #include <wasm_simd128.h>
+#endif
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+    #define PGEX_MA_MMAP
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
 
 void PGEX_MA_LOG(const std::string_view& message = "", std::source_location location = std::source_location::current())
 {
@@ -297,700 +1238,3685 @@ void PGEX_MA_LOG(const std::string_view& message = "", std::source_location loca
 namespace olc
 {
 
-#pragma region SoundFileBuffer
-
-    MiniAudio::SoundFileBuffer::SoundFileBuffer()
-        : m_engine(nullptr), m_loaded(false)
-    {
-    }
-
-    MiniAudio::SoundFileBuffer::SoundFileBuffer(ma_engine* engine)
-        : m_engine(engine), m_loaded(false)
-    {
-    }
-    
-    MiniAudio::SoundFileBuffer::~SoundFileBuffer()
-    {
-    }
-
-    bool MiniAudio::SoundFileBuffer::Load(const std::string& path, olc::ResourcePack* pack)
-    {
-        if(m_loaded)
-        {
-            m_count++;
-            PGEX_MA_LOG(std::format("reusing sound file buffer at path: {}", m_path));
-            return true;
-        }
-
-        if(pack != nullptr)
-        {
-            PGEX_MA_LOG("loading sound file via olc::ResourcePack");
-            
-            if(!pack->Loaded())
-                throw std::runtime_error{std::format("failed to load sound from: {} - olc::ResourcePack", path)};
-                
-            m_buffer = pack->GetFileBuffer(path).vMemory;
-        }
-        else
-        {
-            PGEX_MA_LOG("loading sound file via ifstream");
-
-            std::ifstream file(path, std::ios::binary | std::ios::ate);
-            
-            if(!file.is_open())
-                throw std::runtime_error{std::format("failed to load sound from: {}", path)};
-
-            m_buffer.resize(file.tellg(), 0);
-            file.seekg(0, std::ios::beg);
-        
-            file.read(m_buffer.data(), m_buffer.size());
-        }
-
-        if(ma_resource_manager_register_encoded_data(m_engine->pResourceManager, path.c_str(), m_buffer.data(), m_buffer.size()) != MA_SUCCESS)
-            return false;
-
-        m_count = 1;
-        m_loaded = true;
-        m_path = path;
-        
-        return true;
-    }
-
-    void MiniAudio::SoundFileBuffer::Unload()
-    {
-        if(!m_loaded)
-            throw std::runtime_error{"tried to unload a sound file buffer which isn't loaded"};
-
-        m_count--;
-        
-        PGEX_MA_LOG(std::format("decreased count of: {} to {}", m_path, m_count));
-        
-        if(m_count == 0)
-        {
-            if(ma_resource_manager_unregister_data(m_engine->pResourceManager, m_path.c_str()))
-                throw std::runtime_error{"failed to unregister data from the resource manager"};
-
-            m_loaded = false;
-            
-            PGEX_MA_LOG(std::format("unloaded sound file buffer with path: {}", m_path));
-        }
-    }
-
-#pragma endregion
-
 #pragma region Sound
 
     const std::string MiniAudio::Sound::string()
     {
         return std::format(
-            "{}, frames({}) seconds({}) play_once({})",
+            "{}, frames({}) seconds({}) play_once({}) streamed({})",
             m_path,
             m_length_in_pcm_frames,
             m_length_in_seconds,
-            m_play_once
+            m_play_once,
+            m_streamed
         );
     }
 
 #pragma endregion
 
-#pragma region Waveform
-    MiniAudio::Waveform::Waveform()
+#pragma region Kernels
+
+    static void mix_add_scalar(float* dst, const float* src, const size_t count)
     {
+        for(size_t i = 0; i < count; i++)
+            dst[i] += src[i];
     }
 
-    MiniAudio::Waveform::Waveform(const double amplitude, const double frequency, const ma_waveform_type waveformType)
+    static void mix_add_gain_scalar(float* dst, const float* src, const float gain, const size_t count)
     {
-        m_waveform_config = ma_waveform_config_init(
-            DEVICE_FORMAT,
-            DEVICE_CHANNELS,
-            DEVICE_SAMPLE_RATE,
-            waveformType,
-            amplitude,
-            frequency
-        );
-        
-        if(ma_waveform_init(&m_waveform_config, &m_waveform) != MA_SUCCESS)
-            throw std::runtime_error{"failed to initialize a waveform"};
-        
-        m_is_loaded = true;
+        for(size_t i = 0; i < count; i++)
+            dst[i] += src[i] * gain;
     }
 
-    void MiniAudio::Waveform::Start()
+    static void clamp_scalar(float* dst, const size_t count)
     {
-        m_is_playing = true;
+        for(size_t i = 0; i < count; i++)
+            dst[i] = std::clamp(dst[i], -1.0f, 1.0f);
     }
 
-    void MiniAudio::Waveform::Stop()
+#ifdef PGEX_MA_SSE2
+    static void mix_add_sse2(float* dst, const float* src, const size_t count)
     {
-        m_is_playing = false;
+        size_t i = 0;
+        for(; i + 4 <= count; i += 4)
+            _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i)));
+
+        mix_add_scalar(dst + i, src + i, count - i);
     }
 
-    void MiniAudio::Waveform::Unload()
+    static void mix_add_gain_sse2(float* dst, const float* src, const float gain, const size_t count)
     {
-        m_is_loaded = false;
+        const __m128 g = _mm_set1_ps(gain);
+        
+        size_t i = 0;
+        for(; i + 4 <= count; i += 4)
+            _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+
+        mix_add_gain_scalar(dst + i, src + i, gain, count - i);
     }
 
-    bool MiniAudio::Waveform::IsPlaying() const
+    static void clamp_sse2(float* dst, const size_t count)
     {
-        return m_is_playing;
+        const __m128 lo = _mm_set1_ps(-1.0f);
+        const __m128 hi = _mm_set1_ps(1.0f);
+        
+        size_t i = 0;
+        for(; i + 4 <= count; i += 4)
+            _mm_storeu_ps(dst + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(dst + i), lo), hi));
+
+        clamp_scalar(dst + i, count - i);
     }
+#endif
 
-    bool MiniAudio::Waveform::IsLoaded()
+#ifdef PGEX_MA_AVX2
+    static bool cpu_has_avx2()
     {
-        return m_is_loaded;
+    #if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if(info[0] < 7)
+            return false;
+        
+        // the OS has to save the ymm registers for us too
+        __cpuid(info, 1);
+        if((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+            return false;
+        
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    #else
+        return __builtin_cpu_supports("avx2");
+    #endif
     }
 
-    ma_waveform* MiniAudio::Waveform::Get()
+    PGEX_MA_TARGET_AVX2 static void mix_add_avx2(float* dst, const float* src, const size_t count)
     {
-        return &m_waveform;
+        size_t i = 0;
+        for(; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_loadu_ps(src + i)));
+
+        mix_add_scalar(dst + i, src + i, count - i);
     }
 
-#pragma endregion
+    PGEX_MA_TARGET_AVX2 static void mix_add_gain_avx2(float* dst, const float* src, const float gain, const size_t count)
+    {
+        const __m256 g = _mm256_set1_ps(gain);
+        
+        size_t i = 0;
+        for(; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g)));
 
-#pragma region MiniAudio
+        mix_add_gain_scalar(dst + i, src + i, gain, count - i);
+    }
 
-    bool MiniAudio::m_background_playback = false;
-    std::vector<float> MiniAudio::m_engine_buffer;
-    std::vector<float> MiniAudio::m_waveform_buffer;
+    PGEX_MA_TARGET_AVX2 static void clamp_avx2(float* dst, const size_t count)
+    {
+        const __m256 lo = _mm256_set1_ps(-1.0f);
+        const __m256 hi = _mm256_set1_ps(1.0f);
+        
+        size_t i = 0;
+        for(; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(dst + i), lo), hi));
 
-    std::vector<MiniAudio::Waveform> MiniAudio::m_waveforms;
-    std::function<void(float& out_audio_data_left, float& out_audio_data_right, const float fElapsedTime)> MiniAudio::m_noise_callback;
-    float MiniAudio::m_noise_left_channel = 0.0f;
-    float MiniAudio::m_noise_right_channel = 0.0f;
+        clamp_scalar(dst + i, count - i);
+    }
+#endif
 
-    MiniAudio::MiniAudio() : olc::PGEX(true)
+#ifdef PGEX_MA_NEON
+    static void mix_add_neon(float* dst, const float* src, const size_t count)
     {
-        m_device_config = ma_device_config_init(DEVICE_TYPE);
-        m_device_config.playback.format = DEVICE_FORMAT;
-        m_device_config.playback.channels = DEVICE_CHANNELS;
-        m_device_config.sampleRate = DEVICE_SAMPLE_RATE;
-        m_device_config.dataCallback = MiniAudio::data_callback;
-        m_device_config.pUserData = this;
+        size_t i = 0;
+        for(; i + 4 <= count; i += 4)
+            vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vld1q_f32(src + i)));
 
-        if(ma_device_init(NULL, &m_device_config, &m_device) != MA_SUCCESS)
-            throw std::runtime_error{"PGEX_MiniAudio: failed to initialize device"};
+        mix_add_scalar(dst + i, src + i, count - i);
+    }
 
-        m_resource_manager_config = ma_resource_manager_config_init();
-        m_resource_manager_config.decodedFormat     = DEVICE_FORMAT;
-        m_resource_manager_config.decodedChannels   = DEVICE_CHANNELS;
-        m_resource_manager_config.decodedSampleRate = DEVICE_SAMPLE_RATE;
-    
-    #ifdef __EMSCRIPTEN__
-        m_resource_manager_config.jobThreadCount = 0;                           
-        m_resource_manager_config.flags |= MA_RESOURCE_MANAGER_FLAG_NON_BLOCKING;
-        m_resource_manager_config.flags |= MA_RESOURCE_MANAGER_FLAG_NO_THREADING;
-    #endif
+    static void mix_add_gain_neon(float* dst, const float* src, const float gain, const size_t count)
+    {
+        size_t i = 0;
+        for(; i + 4 <= count; i += 4)
+            vst1q_f32(dst + i, vmlaq_n_f32(vld1q_f32(dst + i), vld1q_f32(src + i), gain));
 
-        if(ma_resource_manager_init(&m_resource_manager_config, &m_resource_manager) != MA_SUCCESS)
-            throw std::runtime_error{"PGEX_MiniAudio: failed to initialize resource manager"};
-    
-        m_engine_config = ma_engine_config_init();
-        m_engine_config.pDevice = &m_device;
-        m_engine_config.pResourceManager = &m_resource_manager;
-    
-        if(ma_engine_init(&m_engine_config, &m_engine) != MA_SUCCESS)
-            throw std::runtime_error{"PGEX_MiniAudio: failed to initialize engine"};
+        mix_add_gain_scalar(dst + i, src + i, gain, count - i);
+    }
 
-        m_initialized = true;
+    static void clamp_neon(float* dst, const size_t count)
+    {
+        const float32x4_t lo = vdupq_n_f32(-1.0f);
+        const float32x4_t hi = vdupq_n_f32(1.0f);
+        
+        size_t i = 0;
+        for(; i + 4 <= count; i += 4)
+            vst1q_f32(dst + i, vminq_f32(vmaxq_f32(vld1q_f32(dst + i), lo), hi));
+
+        clamp_scalar(dst + i, count - i);
     }
+#endif
 
-    MiniAudio::~MiniAudio()
+#ifdef PGEX_MA_WASM_SIMD
+    static void mix_add_wasm(float* dst, const float* src, const size_t count)
     {
-        PGEX_MA_LOG("unloading all sounds");
+        size_t i = 0;
+        for(; i + 4 <= count; i += 4)
+            wasm_v128_store(dst + i, wasm_f32x4_add(wasm_v128_load(dst + i), wasm_v128_load(src + i)));
 
-        /**
-         * unload all sounds
-         */
-        for(int i = 0; i < m_sounds.size(); i++)
-        {
-            if(m_sounds.at(i) == nullptr)
-                continue;
-            
-            UnloadSound(i);
-        }
+        mix_add_scalar(dst + i, src + i, count - i);
+    }
 
-        PGEX_MA_LOG("uninitializing m_engine");
-        ma_engine_stop(&m_engine);
-        ma_engine_uninit(&m_engine);
+    static void mix_add_gain_wasm(float* dst, const float* src, const float gain, const size_t count)
+    {
+        const v128_t g = wasm_f32x4_splat(gain);
         
-        PGEX_MA_LOG("uninitializing m_resource_manager");
-        ma_resource_manager_uninit(&m_resource_manager);
+        size_t i = 0;
+        for(; i + 4 <= count; i += 4)
+            wasm_v128_store(dst + i, wasm_f32x4_add(wasm_v128_load(dst + i), wasm_f32x4_mul(wasm_v128_load(src + i), g)));
+
+        mix_add_gain_scalar(dst + i, src + i, gain, count - i);
+    }
+
+    static void clamp_wasm(float* dst, const size_t count)
+    {
+        const v128_t lo = wasm_f32x4_splat(-1.0f);
+        const v128_t hi = wasm_f32x4_splat(1.0f);
         
-        PGEX_MA_LOG("uninitializing m_device");
-        ma_device_stop(&m_device);
-        ma_device_uninit(&m_device);
+        size_t i = 0;
+        for(; i + 4 <= count; i += 4)
+            wasm_v128_store(dst + i, wasm_f32x4_pmin(wasm_f32x4_pmax(wasm_v128_load(dst + i), lo), hi));
+
+        clamp_scalar(dst + i, count - i);
     }
+#endif
 
-    bool MiniAudio::OnBeforeUserUpdate(float& fElapsedTime)
+    MiniAudio::Kernels::Path MiniAudio::Kernels::Best()
     {
-        #ifdef __EMSCRIPTEN__
-        ma_resource_manager_process_next_job(&m_resource_manager);
+        static const Path best = []
+        {
+            for(Path path : {Path::AVX2, Path::SSE2, Path::NEON, Path::WasmSIMD})
+            {
+                if(IsSupported(path))
+                    return path;
+            }
+
+            return Path::Scalar;
+        }();
+
+        return best;
+    }
+
+    bool MiniAudio::Kernels::IsSupported(const Path path)
+    {
+        switch(path)
+        {
+            case Path::Scalar:
+                return true;
+        #ifdef PGEX_MA_SSE2
+            case Path::SSE2:
+                return true;
         #endif
-        
-        /**
-         * look for the sounds we play once
-         * if they're done playing unload them
-         */
-        for(int i = 0; i < m_sounds.size(); i++)
+        #ifdef PGEX_MA_AVX2
+            case Path::AVX2:
+                return cpu_has_avx2();
+        #endif
+        #ifdef PGEX_MA_NEON
+            case Path::NEON:
+                return true;
+        #endif
+        #ifdef PGEX_MA_WASM_SIMD
+            case Path::WasmSIMD:
+                return true;
+        #endif
+            default:
+                return false;
+        }
+    }
+
+    const char* MiniAudio::Kernels::Name(const Path path)
+    {
+        switch(path)
         {
-            if(m_sounds.at(i) == nullptr)
-                continue;
-            
-            if(!m_sounds.at(i)->m_play_once)
-                continue;
-            
-            if(ma_sound_is_playing(&m_sounds.at(i)->m_sound))
-                continue;
-            
-            UnloadSound(i);
-            m_count_play_once_sounds--;
+            case Path::Scalar:      return "scalar";
+            case Path::SSE2:        return "sse2";
+            case Path::AVX2:        return "avx2";
+            case Path::NEON:        return "neon";
+            case Path::WasmSIMD:    return "wasm-simd";
         }
-        
-        return false;
+
+        return "unknown";
     }
 
-    void MiniAudio::data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
+    void MiniAudio::Kernels::MixAdd(float* dst, const float* src, const size_t count, const Path path)
+    {
+        switch(path)
+        {
+        #ifdef PGEX_MA_SSE2
+            case Path::SSE2:        mix_add_sse2(dst, src, count); return;
+        #endif
+        #ifdef PGEX_MA_AVX2
+            case Path::AVX2:        mix_add_avx2(dst, src, count); return;
+        #endif
+        #ifdef PGEX_MA_NEON
+            case Path::NEON:        mix_add_neon(dst, src, count); return;
+        #endif
+        #ifdef PGEX_MA_WASM_SIMD
+            case Path::WasmSIMD:    mix_add_wasm(dst, src, count); return;
+        #endif
+            default:                mix_add_scalar(dst, src, count); return;
+        }
+    }
+
+    void MiniAudio::Kernels::MixAddGain(float* dst, const float* src, const float gain, const size_t count, const Path path)
+    {
+        switch(path)
+        {
+        #ifdef PGEX_MA_SSE2
+            case Path::SSE2:        mix_add_gain_sse2(dst, src, gain, count); return;
+        #endif
+        #ifdef PGEX_MA_AVX2
+            case Path::AVX2:        mix_add_gain_avx2(dst, src, gain, count); return;
+        #endif
+        #ifdef PGEX_MA_NEON
+            case Path::NEON:        mix_add_gain_neon(dst, src, gain, count); return;
+        #endif
+        #ifdef PGEX_MA_WASM_SIMD
+            case Path::WasmSIMD:    mix_add_gain_wasm(dst, src, gain, count); return;
+        #endif
+            default:                mix_add_gain_scalar(dst, src, gain, count); return;
+        }
+    }
+
+    void MiniAudio::Kernels::Clamp(float* dst, const size_t count, const Path path)
+    {
+        switch(path)
+        {
+        #ifdef PGEX_MA_SSE2
+            case Path::SSE2:        clamp_sse2(dst, count); return;
+        #endif
+        #ifdef PGEX_MA_AVX2
+            case Path::AVX2:        clamp_avx2(dst, count); return;
+        #endif
+        #ifdef PGEX_MA_NEON
+            case Path::NEON:        clamp_neon(dst, count); return;
+        #endif
+        #ifdef PGEX_MA_WASM_SIMD
+            case Path::WasmSIMD:    clamp_wasm(dst, count); return;
+        #endif
+            default:                clamp_scalar(dst, count); return;
+        }
+    }
+
+#pragma endregion
+
+#pragma region OscillatorBank
+
+    void MiniAudio::OscillatorBank::Resize(const int capacity)
+    {
+        m_phase.assign(capacity, 0);
+        m_increment.assign(capacity, 0);
+        m_amplitude.assign(capacity, 0.0f);
+        m_type.assign(capacity, ma_waveform_type_sine);
+        m_band_limited.assign(capacity, 0);
+        m_ids.assign(capacity, -1);
+        m_slots.assign(capacity, -1);
+        m_playing = 0;
+        m_loaded = 0;
+        m_schedule.clear();
+        m_schedule.reserve(MAX_SCHEDULED_EVENTS);
+    }
+
+    int MiniAudio::OscillatorBank::Capacity() const
+    {
+        return static_cast<int>(m_slots.size());
+    }
+
+    int MiniAudio::OscillatorBank::Playing() const
+    {
+        return m_playing;
+    }
+
+    bool MiniAudio::OscillatorBank::HasScheduled() const
     {
+        return !m_schedule.empty();
+    }
+
+    void MiniAudio::OscillatorBank::Load(const int id, const double amplitude, const double frequency, const ma_waveform_type type, const bool bandLimited, const ma_uint32 sampleRate)
+    {
+        if(m_slots[id] != -1)
+            Unload(id);
+
         /**
-         * Get the instance of the miniaudio pgex for use later
-         * in the callback
+         * new oscillators join the end of the stopped ones
          */
-        MiniAudio* ma = (MiniAudio*)pDevice->pUserData;
+        const int slot = m_loaded++;
+        m_ids[slot] = id;
+        m_slots[id] = slot;
         
-        /**
-         * If the instance of the miniaudio pgex has, for some
-         * reason has not been set, bail
-         */
-        if(ma == nullptr)
-            throw std::runtime_error{"unable to access miniaudio pgex instance from data_callback"};
+        m_phase[slot] = 0;
+        m_increment[slot] = PhaseIncrement(frequency, sampleRate);
+        m_amplitude[slot] = static_cast<float>(amplitude);
+        m_type[slot] = type;
+        m_band_limited[slot] = bandLimited;
+    }
 
-        /**
-         * If background playback isn't enabled and the app
-         * does not have focus, bail
-         */
-        if(!MiniAudio::m_background_playback && !pge->IsFocused())
+    void MiniAudio::OscillatorBank::Unload(const int id)
+    {
+        ClearSchedule(id);
+        Stop(id);
+
+        const int slot = m_slots[id];
+        if(slot == -1)
+            return;
+
+        swap_slots(slot, m_loaded - 1);
+        m_loaded--;
+        m_slots[id] = -1;
+    }
+
+    void MiniAudio::OscillatorBank::Start(const int id)
+    {
+        const int slot = m_slots[id];
+        if(slot == -1 || slot < m_playing)
+            return;
+
+        swap_slots(slot, m_playing);
+        m_playing++;
+    }
+
+    void MiniAudio::OscillatorBank::Stop(const int id)
+    {
+        const int slot = m_slots[id];
+        if(slot == -1 || slot >= m_playing)
+            return;
+
+        swap_slots(slot, m_playing - 1);
+        m_playing--;
+    }
+
+    void MiniAudio::OscillatorBank::SetAmplitude(const int id, const double amplitude)
+    {
+        if(m_slots[id] != -1)
+            m_amplitude[m_slots[id]] = static_cast<float>(amplitude);
+    }
+
+    void MiniAudio::OscillatorBank::SetFrequency(const int id, const double frequency, const ma_uint32 sampleRate)
+    {
+        if(m_slots[id] != -1)
+            m_increment[m_slots[id]] = PhaseIncrement(frequency, sampleRate);
+    }
+
+    void MiniAudio::OscillatorBank::SetType(const int id, const ma_waveform_type type)
+    {
+        if(m_slots[id] != -1)
+            m_type[m_slots[id]] = type;
+    }
+
+    void MiniAudio::OscillatorBank::SetBandLimited(const int id, const bool bandLimited)
+    {
+        if(m_slots[id] != -1)
+            m_band_limited[m_slots[id]] = bandLimited;
+    }
+
+    void MiniAudio::OscillatorBank::Schedule(const int id, const ma_uint64 frame, const bool start)
+    {
+        if(m_slots[id] == -1)
             return;
 
         /**
-         * If required, resize the buffer.
-         * 
-         * Note:    m_engine_buffer is the buffer we mix other buffers
-         *          into prior to copying it to the final output buffer.
+         * never grow on the audio thread, with no room left it
+         * happens straight away instead
          */
-        if(m_engine_buffer.size() != (frameCount * DEVICE_CHANNELS))
+        if(m_schedule.size() == m_schedule.capacity())
         {
-            m_engine_buffer.resize(frameCount * DEVICE_CHANNELS, 0);
-            m_waveform_buffer.resize(frameCount * DEVICE_CHANNELS, 0);
-            PGEX_MA_LOG(std::format("had to resize callback buffers to {} bytes", m_engine_buffer.size() * sizeof(float)));
+            if(start)
+                Start(id);
+            else
+                Stop(id);
+            
+            return;
         }
 
-        /**
-         * read pcm frames from the engine to the buffer
-         */
-        ma_engine_read_pcm_frames(&ma->m_engine, m_engine_buffer.data(), frameCount, NULL);
+        m_schedule.push_back({frame, id, start});
+    }
 
+    void MiniAudio::OscillatorBank::ClearSchedule(const int id)
+    {
+        std::erase_if(m_schedule, [id](const ScheduledEvent& event) { return event.m_id == id; });
+    }
+
+    void MiniAudio::OscillatorBank::Render(float* pOutput, const ma_uint32 frameCount, const ma_uint32 channels, const ma_uint64 clock, const Kernels::Path path)
+    {
         /**
-         * waveforms
+         * render up to the next scheduled frame, start or stop what's
+         * due there, and carry on from it
          */
-        for(Waveform& waveform : MiniAudio::m_waveforms)
+        ma_uint32 framesRendered = 0;
+
+        while(!m_schedule.empty())
+        {
+            const ma_uint64 now = clock + framesRendered;
+
+            /**
+             * everything that's due, earliest first, in the order they
+             * were scheduled when they're due on the same frame
+             */
+            for(;;)
+            {
+                auto due = m_schedule.end();
+                
+                for(auto event = m_schedule.begin(); event != m_schedule.end(); ++event)
+                {
+                    if(event->m_frame <= now && (due == m_schedule.end() || event->m_frame < due->m_frame))
+                        due = event;
+                }
+
+                if(due == m_schedule.end())
+                    break;
+
+                if(due->m_start)
+                    Start(due->m_id);
+                else
+                    Stop(due->m_id);
+
+                m_schedule.erase(due);
+            }
+
+            ma_uint64 next = clock + frameCount;
+            
+            for(const ScheduledEvent& event : m_schedule)
+                next = std::min(next, event.m_frame);
+
+            render_playing(pOutput + (static_cast<size_t>(framesRendered) * channels), static_cast<ma_uint32>(next - now), channels, path);
+            framesRendered = static_cast<ma_uint32>(next - clock);
+
+            if(framesRendered == frameCount)
+                return;
+        }
+
+        render_playing(pOutput + (static_cast<size_t>(framesRendered) * channels), frameCount - framesRendered, channels, path);
+    }
+
+    void MiniAudio::OscillatorBank::render_playing(float* pOutput, const ma_uint32 frameCount, const ma_uint32 channels, const Kernels::Path path)
+    {
+        if(m_playing == 0)
+            return;
+
+        for(ma_uint32 start = 0; start < frameCount; start += TILE_FRAMES)
         {
-            if(!waveform.IsLoaded())
+            const ma_uint32 frames = std::min(TILE_FRAMES, frameCount - start);
+            
+            std::fill_n(m_tile.begin(), frames, 0.0f);
+            float* tile = m_tile.data();
+
+            /**
+             * every oscillator adds itself to a mono tile, it's the
+             * same on every channel
+             */
+            for(int k = 0; k < m_playing; k++)
+                m_phase[k] = Accumulate(tile, frames, m_phase[k], m_increment[k], m_amplitude[k], m_type[k], m_band_limited[k]);
+
+            /**
+             * one pass over the output for all of them, a straight
+             * mix-add when the output is mono too
+             */
+            float* output = pOutput + (static_cast<size_t>(start) * channels);
+            
+            if(channels == 1)
+            {
+                Kernels::MixAdd(output, tile, frames, path);
                 continue;
+            }
 
-            if(waveform.IsPlaying())
+            for(ma_uint32 i = 0; i < frames; i++)
             {
-                ma_uint64 framesRead;
+                for(ma_uint32 c = 0; c < channels; c++)
+                    output[i * channels + c] += tile[i];
+            }
+        }
+    }
 
+    ma_uint32 MiniAudio::OscillatorBank::Accumulate(float* pOutput, const ma_uint32 frameCount, const ma_uint32 phase, const ma_uint32 increment, const float amplitude, const ma_waveform_type type, const bool bandLimited)
+    {
+        constexpr double PHASE_TO_RADIANS = 6.283185307179586476925286766559 / 4294967296.0;
+        constexpr float PHASE_TO_UNIT = 1.0f / 2147483648.0f;
+        constexpr float PHASE_TO_CYCLES = 1.0f / 4294967296.0f;
+        constexpr ma_uint32 HALF_CYCLE = 0x80000000u;
+
+        /**
+         * the loops work out each frame's phase from the first, so
+         * they carry nothing from one frame to the next and vectorize.
+         * band limiting only makes sense below nyquist, and running
+         * forwards.
+         */
+        if(bandLimited && increment < HALF_CYCLE && type != ma_waveform_type_sine)
+        {
+            /**
+             * the naive shapes with their steps and corners smoothed
+             * over the frame either side of them
+             */
+            switch(type)
+            {
+                case ma_waveform_type_square:
+                    for(ma_uint32 i = 0; i < frameCount; i++)
+                    {
+                        const ma_uint32 p = phase + i * increment;
+                        const float square = (p & HALF_CYCLE) ? -1.0f : 1.0f;
+                        pOutput[i] += amplitude * (square + poly_blep(p, increment) - poly_blep(p + HALF_CYCLE, increment));
+                    }
+                    break;
+
+                case ma_waveform_type_triangle:
+                {
+                    // the slope turns by 8 per cycle at each corner, scaled to per frame
+                    const float turn = 8.0f * (increment * PHASE_TO_CYCLES);
+                    
+                    for(ma_uint32 i = 0; i < frameCount; i++)
+                    {
+                        const ma_uint32 p = phase + i * increment;
+                        const float saw = static_cast<float>(static_cast<ma_int32>(p - HALF_CYCLE)) * PHASE_TO_UNIT;
+                        const float triangle = 2.0f * std::abs(saw) - 1.0f;
+                        pOutput[i] += amplitude * (triangle + turn * (poly_blamp(p + HALF_CYCLE, increment) - poly_blamp(p, increment)));
+                    }
+                    break;
+                }
+
+                default:
+                    for(ma_uint32 i = 0; i < frameCount; i++)
+                    {
+                        const ma_uint32 p = phase + i * increment;
+                        const float saw = static_cast<float>(static_cast<ma_int32>(p - HALF_CYCLE)) * PHASE_TO_UNIT;
+                        pOutput[i] += amplitude * (saw - poly_blep(p, increment));
+                    }
+                    break;
+            }
+
+            return phase + frameCount * increment;
+        }
+
+        switch(type)
+        {
+            case ma_waveform_type_sine:
+            {
                 /**
-                 * read pcm frames from the waveform to the buffer
-                 */
-                ma_result result = ma_waveform_read_pcm_frames(waveform.Get(), m_waveform_buffer.data(), frameCount, &framesRead);
-                
-                /**
-                 * if reading failed, or read 0 frames, skip
-                 */
-                if(result != MA_SUCCESS || framesRead == 0)
-                    continue;
-                
-                /**
-                 * mix waveform buffer into the engine buffer, simple add
+                 * the one exception, a phasor rotated a frame at a time,
+                 * started afresh every call so it can't drift
                  */
-                for(ma_uint64 i = 0; i < framesRead * DEVICE_CHANNELS; i++)
+                const double step = increment * PHASE_TO_RADIANS;
+                const double stepSin = std::sin(step);
+                const double stepCos = std::cos(step);
+                double s = std::sin(phase * PHASE_TO_RADIANS);
+                double c = std::cos(phase * PHASE_TO_RADIANS);
+
+                for(ma_uint32 i = 0; i < frameCount; i++)
                 {
-                    m_engine_buffer[i] += m_waveform_buffer[i];
+                    pOutput[i] += amplitude * static_cast<float>(s);
+                    
+                    const double next = s * stepCos + c * stepSin;
+                    c = c * stepCos - s * stepSin;
+                    s = next;
                 }
+                break;
             }
+
+            case ma_waveform_type_square:
+                for(ma_uint32 i = 0; i < frameCount; i++)
+                    pOutput[i] += ((phase + i * increment) & HALF_CYCLE) ? -amplitude : amplitude;
+                break;
+
+            case ma_waveform_type_triangle:
+                for(ma_uint32 i = 0; i < frameCount; i++)
+                {
+                    const float saw = static_cast<float>(static_cast<ma_int32>(phase + i * increment - HALF_CYCLE)) * PHASE_TO_UNIT;
+                    pOutput[i] += amplitude * (2.0f * std::abs(saw) - 1.0f);
+                }
+                break;
+
+            case ma_waveform_type_sawtooth:
+                for(ma_uint32 i = 0; i < frameCount; i++)
+                    pOutput[i] += amplitude * static_cast<float>(static_cast<ma_int32>(phase + i * increment - HALF_CYCLE)) * PHASE_TO_UNIT;
+                break;
         }
-        
+
+        return phase + frameCount * increment;
+    }
+
+    void MiniAudio::OscillatorBank::swap_slots(const int a, const int b)
+    {
+        if(a == b)
+            return;
+
+        std::swap(m_phase[a], m_phase[b]);
+        std::swap(m_increment[a], m_increment[b]);
+        std::swap(m_amplitude[a], m_amplitude[b]);
+        std::swap(m_type[a], m_type[b]);
+        std::swap(m_band_limited[a], m_band_limited[b]);
+        std::swap(m_ids[a], m_ids[b]);
+
+        m_slots[m_ids[a]] = a;
+        m_slots[m_ids[b]] = b;
+    }
+
+    float MiniAudio::OscillatorBank::poly_blep(const ma_uint32 phase, const ma_uint32 increment)
+    {
         /**
-         * noise generators
+         * the frame just after the step, and the frame just before it.
+         * distances are measured in whole uint32s so nothing is lost to
+         * float precision near the end of the cycle.
          */
-        if(m_noise_callback)
+        if(phase < increment)
         {
-            for(ma_uint32 i = 0; i < frameCount; i++)
-            {
-                m_noise_callback(m_noise_left_channel, m_noise_right_channel, 1.0f / DEVICE_SAMPLE_RATE);
+            const float x = static_cast<float>(phase) / static_cast<float>(increment);
+            return x + x - x * x - 1.0f;
+        }
 
-                m_engine_buffer[(i * DEVICE_CHANNELS)] += m_noise_left_channel;
-                m_engine_buffer[(i * DEVICE_CHANNELS) + 1] += m_noise_right_channel;
-            }
+        if(phase > 0u - increment)
+        {
+            const float x = -static_cast<float>(0u - phase) / static_cast<float>(increment);
+            return x * x + x + x + 1.0f;
+        }
+
+        return 0.0f;
+    }
+
+    float MiniAudio::OscillatorBank::poly_blamp(const ma_uint32 phase, const ma_uint32 increment)
+    {
+        if(phase < increment)
+        {
+            const float x = static_cast<float>(phase) / static_cast<float>(increment) - 1.0f;
+            return -(x * x * x) / 3.0f;
+        }
+
+        if(phase > 0u - increment)
+        {
+            const float x = 1.0f - static_cast<float>(0u - phase) / static_cast<float>(increment);
+            return (x * x * x) / 3.0f;
+        }
+
+        return 0.0f;
+    }
+
+    ma_uint32 MiniAudio::OscillatorBank::PhaseIncrement(const double frequency, const ma_uint32 sampleRate)
+    {
+        /**
+         * a cycle is 2^32, wrapping through int64 keeps negative
+         * frequencies running backwards, just like ma_waveform
+         */
+        return static_cast<ma_uint32>(static_cast<ma_int64>(std::llround(frequency / sampleRate * 4294967296.0)));
+    }
+
+#pragma endregion
+
+#pragma region Synth
+
+    void MiniAudio::Synth::Resize(const int voices, const int instruments, const ma_uint32 sampleRate)
+    {
+        m_voices.assign(voices, Voice{});
+        m_instruments.assign(instruments, Instrument{});
+        m_active = 0;
+        m_sample_rate = sampleRate;
+        m_note_clock = 0;
+    }
+
+    int MiniAudio::Synth::InstrumentCapacity() const
+    {
+        return static_cast<int>(m_instruments.size());
+    }
+
+    void MiniAudio::Synth::SetInstrument(const int id, const Instrument& instrument)
+    {
+        m_instruments[id] = instrument;
+
+        /**
+         * everything else is read from the instrument as it renders,
+         * the partials' pitches are worked out once per note
+         */
+        for(int v = 0; v < m_active; v++)
+        {
+            if(m_voices[v].m_instrument == id)
+                tune_voice(m_voices[v]);
+        }
+    }
+
+    void MiniAudio::Synth::UnloadInstrument(const int id)
+    {
+        for(int v = 0; v < m_active;)
+        {
+            if(m_voices[v].m_instrument == id)
+                free_voice(v);
+            else
+                v++;
+        }
+    }
+
+    void MiniAudio::Synth::NoteOn(const int note, const int instrument, const float frequency, const float velocity)
+    {
+        if(m_voices.empty())
+            return;
+
+        Voice& voice = m_voices[claim_voice()];
+
+        voice.m_note = note;
+        voice.m_instrument = instrument;
+        voice.m_velocity = velocity;
+        voice.m_frequency = frequency;
+        voice.m_started = m_note_clock++;
+        voice.m_stage = Stage::Attack;
+        voice.m_vibrato_phase = 0;
+        voice.m_noise_state = static_cast<ma_uint32>(note) * 2654435761u | 1u;
+
+        voice.m_phase.fill(0);
+        tune_voice(voice);
+
+        /**
+         * m_level is left as it was, a stolen voice attacks from
+         * wherever it had got to rather than clicking down to 0
+         */
+    }
+
+    void MiniAudio::Synth::NoteOff(const int note)
+    {
+        for(int v = 0; v < m_active; v++)
+        {
+            if(m_voices[v].m_note == note)
+            {
+                release_voice(m_voices[v]);
+                return;
+            }
+        }
+    }
+
+    void MiniAudio::Synth::AllNotesOff()
+    {
+        for(int v = 0; v < m_active; v++)
+            release_voice(m_voices[v]);
+    }
+
+    int MiniAudio::Synth::ActiveVoices() const
+    {
+        return m_active;
+    }
+
+    void MiniAudio::Synth::Render(float* pOutput, const ma_uint32 frameCount, const ma_uint32 channels, const Kernels::Path path)
+    {
+        if(m_active == 0)
+            return;
+
+        const bool stereo = (channels == 2);
+
+        for(ma_uint32 start = 0; start < frameCount; start += TILE_FRAMES)
+        {
+            const ma_uint32 frames = std::min(TILE_FRAMES, frameCount - start);
+
+            std::fill_n(m_left.begin(), frames, 0.0f);
+            std::fill_n(m_right.begin(), frames, 0.0f);
+
+            for(int v = 0; v < m_active;)
+            {
+                Voice& voice = m_voices[v];
+                const bool sounding = render_voice(voice, frames);
+
+                /**
+                 * pan like miniaudio's balance, the far side is turned
+                 * down and the near side left alone
+                 */
+                const Instrument& instrument = m_instruments[voice.m_instrument];
+                const float gain = instrument.volume * voice.m_velocity;
+                const float pan = std::clamp(instrument.pan, -1.0f, 1.0f);
+                const float leftGain = stereo ? gain * std::min(1.0f, 1.0f - pan) : gain;
+                const float rightGain = gain * std::min(1.0f, 1.0f + pan);
+
+                Kernels::MixAddGain(m_left.data(), m_voice_tile.data(), leftGain, frames, path);
+
+                if(stereo)
+                    Kernels::MixAddGain(m_right.data(), m_voice_tile.data(), rightGain, frames, path);
+
+                if(sounding)
+                    v++;
+                else
+                    free_voice(v);
+            }
+
+            float* output = pOutput + (static_cast<size_t>(start) * channels);
+
+            if(stereo)
+            {
+                for(ma_uint32 i = 0; i < frames; i++)
+                {
+                    output[i * 2] += m_left[i];
+                    output[i * 2 + 1] += m_right[i];
+                }
+            }
+            else if(channels == 1)
+            {
+                Kernels::MixAdd(output, m_left.data(), frames, path);
+            }
+            else
+            {
+                for(ma_uint32 i = 0; i < frames; i++)
+                {
+                    for(ma_uint32 c = 0; c < channels; c++)
+                        output[i * channels + c] += m_left[i];
+                }
+            }
+
+            if(m_active == 0)
+                return;
+        }
+    }
+
+    int MiniAudio::Synth::claim_voice()
+    {
+        if(m_active < static_cast<int>(m_voices.size()))
+        {
+            m_voices[m_active].m_level = 0.0f;
+            return m_active++;
+        }
+
+        /**
+         * every voice is busy, steal the quietest one that's already
+         * fading out, it'll be missed the least. otherwise the oldest.
+         */
+        int quietest = -1;
+        int oldest = 0;
+
+        for(int v = 0; v < m_active; v++)
+        {
+            const Voice& voice = m_voices[v];
+
+            if(voice.m_stage == Stage::Release && (quietest == -1 || voice.m_level < m_voices[quietest].m_level))
+                quietest = v;
+
+            if(voice.m_started < m_voices[oldest].m_started)
+                oldest = v;
+        }
+
+        return (quietest != -1) ? quietest : oldest;
+    }
+
+    void MiniAudio::Synth::release_voice(Voice& voice)
+    {
+        if(voice.m_stage == Stage::Release)
+            return;
+
+        const float release = m_instruments[voice.m_instrument].envelope.release;
+
+        voice.m_stage = Stage::Release;
+        voice.m_release_step = (release > 0.0f) ? voice.m_level / (release * m_sample_rate) : voice.m_level;
+    }
+
+    void MiniAudio::Synth::free_voice(const int index)
+    {
+        m_active--;
+        std::swap(m_voices[index], m_voices[m_active]);
+        m_voices[m_active].m_note = -1;
+    }
+
+    void MiniAudio::Synth::tune_voice(Voice& voice)
+    {
+        const Instrument& sound = m_instruments[voice.m_instrument];
+
+        for(int p = 0; p < Instrument::MAX_PARTIALS; p++)
+            voice.m_increment[p] = OscillatorBank::PhaseIncrement(voice.m_frequency * std::exp2(sound.partials[p].semitones / 12.0), m_sample_rate);
+    }
+
+    bool MiniAudio::Synth::render_voice(Voice& voice, const ma_uint32 frames)
+    {
+        constexpr double PHASE_TO_RADIANS = 6.283185307179586476925286766559 / 4294967296.0;
+
+        const Instrument& instrument = m_instruments[voice.m_instrument];
+        float* tile = m_voice_tile.data();
+        
+        std::fill_n(tile, frames, 0.0f);
+
+        /**
+         * vibrato is slow, it's worked out once a tile and bends
+         * every partial by the same ratio
+         */
+        double bend = 1.0;
+        
+        if(instrument.vibratoSemitones != 0.0f && instrument.vibratoHertz != 0.0f)
+        {
+            bend = std::exp2(instrument.vibratoSemitones * std::sin(voice.m_vibrato_phase * PHASE_TO_RADIANS) / 12.0);
+            voice.m_vibrato_phase += frames * OscillatorBank::PhaseIncrement(instrument.vibratoHertz, m_sample_rate);
+        }
+
+        for(int p = 0; p < Instrument::MAX_PARTIALS; p++)
+        {
+            const Partial& partial = instrument.partials[p];
+            
+            if(partial.amplitude == 0.0f)
+                continue;
+
+            const ma_uint32 increment = (bend == 1.0) ? voice.m_increment[p] : static_cast<ma_uint32>(std::min(voice.m_increment[p] * bend, 4294967295.0));
+            voice.m_phase[p] = OscillatorBank::Accumulate(tile, frames, voice.m_phase[p], increment, partial.amplitude, partial.type, partial.bandLimited);
+        }
+
+        if(instrument.noise != 0.0f)
+        {
+            /**
+             * xorshift, cheap and plenty random enough to listen to
+             */
+            ma_uint32 state = voice.m_noise_state;
+            
+            for(ma_uint32 i = 0; i < frames; i++)
+            {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                tile[i] += instrument.noise * static_cast<float>(static_cast<ma_int32>(state)) * (1.0f / 2147483648.0f);
+            }
+            
+            voice.m_noise_state = state;
+        }
+
+        /**
+         * the envelope, linear ramps from one stage to the next. the
+         * instrument's envelope is read fresh every tile, so changes to
+         * it are heard on notes already sounding.
+         */
+        const Envelope& envelope = instrument.envelope;
+        const float sustain = std::clamp(envelope.sustain, 0.0f, 1.0f);
+        const float attackStep = (envelope.attack > 0.0f) ? 1.0f / (envelope.attack * m_sample_rate) : 1.0f;
+        const float decayStep = (envelope.decay > 0.0f) ? (1.0f - sustain) / (envelope.decay * m_sample_rate) : 1.0f;
+        float level = voice.m_level;
+
+        for(ma_uint32 i = 0; i < frames; i++)
+        {
+            switch(voice.m_stage)
+            {
+                case Stage::Attack:
+                    level += attackStep;
+                    if(level >= 1.0f)
+                    {
+                        level = 1.0f;
+                        voice.m_stage = Stage::Decay;
+                    }
+                    break;
+
+                case Stage::Decay:
+                    level -= decayStep;
+                    if(level <= sustain)
+                    {
+                        level = sustain;
+                        voice.m_stage = Stage::Sustain;
+                    }
+                    break;
+
+                case Stage::Sustain:
+                    level = sustain;
+                    break;
+
+                case Stage::Release:
+                    level = std::max(0.0f, level - voice.m_release_step);
+                    break;
+            }
+
+            tile[i] *= level;
+        }
+
+        voice.m_level = level;
+
+        /**
+         * done once it's faded out, or it's holding a sustain of
+         * nothing, a plucked or struck sound that's died away
+         */
+        if(level <= 0.0f && (voice.m_stage == Stage::Release || voice.m_stage == Stage::Sustain))
+            return false;
+
+        return true;
+    }
+
+#pragma endregion
+
+#pragma region CallbackStats
+
+    int MiniAudio::CallbackStats::bucket(const ma_uint64 ns)
+    {
+        if(ns < 4)
+            return static_cast<int>(ns);
+
+        /**
+         * the power of two picks the octave, the next two bits below
+         * it pick one of four buckets within it
+         */
+        const int octave = std::bit_width(ns) - 1;
+        const int quarter = static_cast<int>((ns >> (octave - 2)) & 3);
+
+        return std::min(octave * 4 + quarter, BUCKETS - 1);
+    }
+
+    ma_uint64 MiniAudio::CallbackStats::bucket_upper_ns(const int bucket)
+    {
+        // 4 to 7 are never filled, the first real octave starts at 8
+        if(bucket < 8)
+            return static_cast<ma_uint64>(bucket) + 1;
+
+        const int octave = bucket / 4;
+        const ma_uint64 quarter = static_cast<ma_uint64>(bucket % 4);
+
+        return (4 + quarter + 1) << (octave - 2);
+    }
+
+    void MiniAudio::CallbackStats::Record(const ma_uint64 ns, const ma_uint32 frames, const ma_uint32 sampleRate)
+    {
+        if(m_reset_requested.exchange(false, std::memory_order_acquire))
+        {
+            m_callbacks.store(0, std::memory_order_relaxed);
+            m_frames.store(0, std::memory_order_relaxed);
+            m_total_ns.store(0, std::memory_order_relaxed);
+            m_total_budget_ns.store(0, std::memory_order_relaxed);
+            m_min_ns.store(0, std::memory_order_relaxed);
+            m_max_ns.store(0, std::memory_order_relaxed);
+            m_load.store(0.0f, std::memory_order_relaxed);
+            m_max_load.store(0.0f, std::memory_order_relaxed);
+            m_late.store(0, std::memory_order_relaxed);
+            
+            for(auto& count : m_histogram)
+                count.store(0, std::memory_order_relaxed);
+        }
+
+        /**
+         * the budget is how long the audio we were asked for lasts
+         */
+        const ma_uint64 budget = (static_cast<ma_uint64>(frames) * 1000000000ull) / sampleRate;
+        const float load = (budget != 0) ? static_cast<float>(ns) / static_cast<float>(budget) : 0.0f;
+        const ma_uint64 callbacks = m_callbacks.load(std::memory_order_relaxed);
+
+        if(callbacks == 0 || ns < m_min_ns.load(std::memory_order_relaxed))
+            m_min_ns.store(ns, std::memory_order_relaxed);
+
+        if(ns > m_max_ns.load(std::memory_order_relaxed))
+            m_max_ns.store(ns, std::memory_order_relaxed);
+
+        if(load > m_max_load.load(std::memory_order_relaxed))
+            m_max_load.store(load, std::memory_order_relaxed);
+
+        if(ns > budget)
+            m_late.store(m_late.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        std::atomic<ma_uint32>& count = m_histogram[bucket(ns)];
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        m_load.store(load, std::memory_order_relaxed);
+        m_frames.store(m_frames.load(std::memory_order_relaxed) + frames, std::memory_order_relaxed);
+        m_total_ns.store(m_total_ns.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+        m_total_budget_ns.store(m_total_budget_ns.load(std::memory_order_relaxed) + budget, std::memory_order_relaxed);
+        m_callbacks.store(callbacks + 1, std::memory_order_release);
+    }
+
+    MiniAudio::AudioStats MiniAudio::CallbackStats::Snapshot() const
+    {
+        AudioStats stats;
+
+        stats.callbacks = m_callbacks.load(std::memory_order_acquire);
+        if(stats.callbacks == 0)
+            return stats;
+
+        const ma_uint64 total = m_total_ns.load(std::memory_order_relaxed);
+        const ma_uint64 totalBudget = m_total_budget_ns.load(std::memory_order_relaxed);
+
+        stats.framesProcessed = m_frames.load(std::memory_order_relaxed);
+        stats.minMicroseconds = m_min_ns.load(std::memory_order_relaxed) / 1000.0f;
+        stats.maxMicroseconds = m_max_ns.load(std::memory_order_relaxed) / 1000.0f;
+        stats.averageMicroseconds = (total / static_cast<float>(stats.callbacks)) / 1000.0f;
+        stats.dspLoad = m_load.load(std::memory_order_relaxed);
+        stats.maxDspLoad = m_max_load.load(std::memory_order_relaxed);
+        stats.averageDspLoad = (totalBudget != 0) ? static_cast<float>(total) / static_cast<float>(totalBudget) : 0.0f;
+        stats.lateCallbacks = m_late.load(std::memory_order_relaxed);
+
+        /**
+         * walk the histogram until 99% of the callbacks are behind us
+         */
+        ma_uint64 counted = 0;
+        ma_uint64 histogramTotal = 0;
+        
+        for(const auto& count : m_histogram)
+            histogramTotal += count.load(std::memory_order_relaxed);
+
+        const ma_uint64 target = (histogramTotal * 99 + 99) / 100;
+        
+        for(int i = 0; i < BUCKETS; i++)
+        {
+            counted += m_histogram[i].load(std::memory_order_relaxed);
+            
+            if(counted >= target)
+            {
+                stats.p99Microseconds = std::min(bucket_upper_ns(i) / 1000.0f, stats.maxMicroseconds);
+                break;
+            }
+        }
+
+        return stats;
+    }
+
+#pragma endregion
+
+#pragma region MiniAudio
+
+    bool MiniAudio::m_background_playback = false;
+
+    MiniAudio::MiniAudio() : MiniAudio(Config{})
+    {
+    }
+
+    MiniAudio::MiniAudio(const Config& config) : olc::PGEX(true), m_config(config)
+    {
+        /**
+         * the audio thread's waveforms are allocated before the device
+         * exists, the mixer must never see this vector reallocate
+         */
+        m_oscillators.Resize(std::max(m_config.maxWaveforms, 1));
+
+        ma_uint64 periodSizeInFrames = 0;
+
+        if(m_config.offline)
+        {
+            /**
+             * nothing to ask a device for, fill in the gaps ourselves.
+             * Render hands back floats, so the format is always f32.
+             */
+            m_config.format = ma_format_f32;
+            m_config.channels = (m_config.channels != 0) ? m_config.channels : 2;
+            m_config.sampleRate = (m_config.sampleRate != 0) ? m_config.sampleRate : 48000;
+            m_config.exclusive = false;
+            m_output_frame_bytes = ma_get_bytes_per_frame(m_config.format, m_config.channels);
+
+            /**
+             * without a period to follow, mix in the biggest blocks we
+             * can, unless a period size was asked for
+             */
+            periodSizeInFrames = (m_config.periodSizeInFrames != 0) ? (m_config.periodSizeInFrames + 1) / 2 : MAX_MIX_BUFFER_FRAMES;
+
+            PGEX_MA_LOG(std::format("rendering offline, {} channels at {}Hz", m_config.channels, m_config.sampleRate));
+        }
+        else
+        {
+            m_device_config = ma_device_config_init(ma_device_type_playback);
+            m_device_config.playback.format = m_config.format;
+            m_device_config.playback.channels = m_config.channels;
+            m_device_config.sampleRate = m_config.sampleRate;
+            m_device_config.periodSizeInFrames = m_config.periodSizeInFrames;
+            m_device_config.periods = m_config.periods;
+            m_device_config.dataCallback = MiniAudio::data_callback;
+            m_device_config.pUserData = this;
+
+            /**
+             * the fewer periods queued ahead of the speakers, the sooner
+             * what we mix is heard. two is the least that stays stable.
+             */
+            if(m_config.lowLatency)
+            {
+                m_device_config.performanceProfile = ma_performance_profile_low_latency;
+            
+                if(m_config.periods == 0)
+                    m_device_config.periods = 2;
+            }
+
+            if(m_config.exclusive)
+                m_device_config.playback.shareMode = ma_share_mode_exclusive;
+
+            ma_result result = ma_device_init(NULL, &m_device_config, &m_device);
+        
+            if(result != MA_SUCCESS && m_config.exclusive)
+            {
+                PGEX_MA_LOG("exclusive mode was refused, falling back to shared mode");
+            
+                m_device_config.playback.shareMode = ma_share_mode_shared;
+                result = ma_device_init(NULL, &m_device_config, &m_device);
+            }
+        
+            if(result != MA_SUCCESS)
+                throw std::runtime_error{"PGEX_MiniAudio: failed to initialize device"};
+
+            /**
+             * whatever was left for the device to decide is known now,
+             * everything from here on follows what it settled on
+             */
+            m_config.format = m_device.playback.format;
+            m_config.channels = m_device.playback.channels;
+            m_config.sampleRate = m_device.sampleRate;
+            m_config.periodSizeInFrames = m_device.playback.internalPeriodSizeInFrames;
+            m_config.periods = m_device.playback.internalPeriods;
+            m_config.exclusive = (m_device.playback.shareMode == ma_share_mode_exclusive);
+            m_output_frame_bytes = ma_get_bytes_per_frame(m_config.format, m_config.channels);
+        
+            PGEX_MA_LOG(std::format("device running {} channels at {}Hz, format({})", m_config.channels, m_config.sampleRate, static_cast<int>(m_config.format)));
+
+            /**
+             * size the mix buffers from the period the device actually
+             * settled on, leaving headroom for resampling. this happens
+             * before the engine starts the device and never again.
+             */
+            periodSizeInFrames = m_device.playback.internalPeriodSizeInFrames;
+        
+            if(m_device.playback.internalSampleRate != 0)
+                periodSizeInFrames = (periodSizeInFrames * m_config.sampleRate) / m_device.playback.internalSampleRate + 1;
+        }
+
+        m_kernel_path = Kernels::Best();
+        m_mix_buffer_frames = std::clamp(static_cast<ma_uint32>(periodSizeInFrames * 2), MIN_MIX_BUFFER_FRAMES, MAX_MIX_BUFFER_FRAMES);
+        m_engine_buffer.resize(m_mix_buffer_frames * m_config.channels, 0);
+
+        /**
+         * the synth's voices need the sample rate, which is only known
+         * now, but still before the engine starts the device
+         */
+        m_synth.Resize(std::max(m_config.maxVoices, 1), MAX_INSTRUMENTS, m_config.sampleRate);
+        
+        PGEX_MA_LOG(std::format("mix buffers sized to {} frames, mixing with {}", m_mix_buffer_frames, Kernels::Name(m_kernel_path)));
+
+        /**
+         * files from resource packs are read through our own file
+         * system, everything else is passed on to the default one
+         */
+        ma_default_vfs_init(&m_default_vfs, NULL);
+        m_pack_vfs.m_callbacks = {
+            MiniAudio::vfs_open,
+            MiniAudio::vfs_open_w,
+            MiniAudio::vfs_close,
+            MiniAudio::vfs_read,
+            MiniAudio::vfs_write,
+            MiniAudio::vfs_seek,
+            MiniAudio::vfs_tell,
+            MiniAudio::vfs_info
+        };
+        m_pack_vfs.m_owner = this;
+
+        m_resource_manager_config = ma_resource_manager_config_init();
+        m_resource_manager_config.pVFS              = &m_pack_vfs;
+        m_resource_manager_config.decodedFormat     = ma_format_f32;
+        m_resource_manager_config.decodedChannels   = m_config.channels;
+        m_resource_manager_config.decodedSampleRate = m_config.sampleRate;
+    
+    #ifdef __EMSCRIPTEN__
+        m_resource_manager_config.jobThreadCount = 0;                           
+        m_resource_manager_config.flags |= MA_RESOURCE_MANAGER_FLAG_NON_BLOCKING;
+        m_resource_manager_config.flags |= MA_RESOURCE_MANAGER_FLAG_NO_THREADING;
+    #endif
+
+        if(ma_resource_manager_init(&m_resource_manager_config, &m_resource_manager) != MA_SUCCESS)
+            throw std::runtime_error{"PGEX_MiniAudio: failed to initialize resource manager"};
+    
+        m_engine_config = ma_engine_config_init();
+        m_engine_config.pResourceManager = &m_resource_manager;
+        
+        if(m_config.offline)
+        {
+            m_engine_config.noDevice = MA_TRUE;
+            m_engine_config.channels = m_config.channels;
+            m_engine_config.sampleRate = m_config.sampleRate;
+        }
+        else
+        {
+            m_engine_config.pDevice = &m_device;
+        }
+    
+        if(ma_engine_init(&m_engine_config, &m_engine) != MA_SUCCESS)
+            throw std::runtime_error{"PGEX_MiniAudio: failed to initialize engine"};
+
+        /**
+         * the waveforms, the synth and the noise callback play through
+         * nodes of their own, sources with no inputs and one output
+         */
+        static ma_node_vtable waveformNodeVTable{MiniAudio::waveform_node_process, nullptr, 0, 1, 0};
+        static ma_node_vtable synthNodeVTable{MiniAudio::synth_node_process, nullptr, 0, 1, 0};
+        static ma_node_vtable noiseNodeVTable{MiniAudio::noise_node_process, nullptr, 0, 1, 0};
+
+        init_generator_node(m_waveform_node, &waveformNodeVTable);
+        init_generator_node(m_synth_node, &synthNodeVTable);
+        init_generator_node(m_noise_node, &noiseNodeVTable);
+
+        m_initialized = true;
+    }
+
+    MiniAudio::~MiniAudio()
+    {
+        /**
+         * let any loading still in flight finish first
+         */
+        PGEX_MA_LOG("releasing all load batches");
+
+        for(int i = 0; i < m_load_batches.size(); i++)
+        {
+            if(m_load_batches.at(i).m_in_use)
+                ReleaseBatch(i);
+        }
+
+        PGEX_MA_LOG("unloading all sounds");
+
+        /**
+         * unload all sounds
+         */
+        for(int i = 0; i < m_sounds.size(); i++)
+        {
+            if(!m_sounds[i].m_in_use)
+                continue;
+            
+            UnloadSound(sound_id(i));
+        }
+
+        PGEX_MA_LOG("unloading all sound banks");
+        
+        for(int i = 0; i < m_sound_banks.size(); i++)
+        {
+            if(!m_sound_banks.at(i).m_loaded)
+                continue;
+            
+            UnloadSoundBank(i);
+        }
+
+        PGEX_MA_LOG("uninitializing generator nodes");
+
+        ma_node_uninit(&m_waveform_node, NULL);
+        ma_node_uninit(&m_synth_node, NULL);
+        ma_node_uninit(&m_noise_node, NULL);
+
+        PGEX_MA_LOG("unloading all buses");
+
+        for(int i = 0; i < m_buses.size(); i++)
+        {
+            if(m_buses[i].m_in_use)
+                UnloadBus(i);
+        }
+
+        PGEX_MA_LOG("uninitializing m_engine");
+        if(!m_config.offline)
+            ma_engine_stop(&m_engine);
+        
+        ma_engine_uninit(&m_engine);
+        
+        PGEX_MA_LOG("uninitializing m_resource_manager");
+        ma_resource_manager_uninit(&m_resource_manager);
+        
+        if(!m_config.offline)
+        {
+            PGEX_MA_LOG("uninitializing m_device");
+            ma_device_stop(&m_device);
+            ma_device_uninit(&m_device);
+        }
+
+        /**
+         * the audio thread is gone, free anything still in flight
+         */
+        Command command;
+        while(m_commands.Pop(command))
+        {
+            delete command.m_noise_callback;
+            delete command.m_instrument;
+        }
+        
+        collect_garbage();
+        delete m_noise_block_callback;
+    }
+
+    bool MiniAudio::OnBeforeUserUpdate(float& fElapsedTime)
+    {
+        #ifdef __EMSCRIPTEN__
+        ma_resource_manager_process_next_job(&m_resource_manager);
+        #endif
+        
+        collect_garbage();
+
+        /**
+         * unload the sounds we play once which have reached their
+         * end, the audio thread tells us which ones they are
+         */
+        int id;
+        while(m_ended_sounds.Pop(id))
+            reap_sound(id);
+
+        /**
+         * if the audio thread couldn't tell us, look at them all
+         */
+        if(m_ended_sounds_overflowed.exchange(false))
+        {
+            for(int i = 0; i < m_sounds.size(); i++)
+            {
+                if(m_sounds[i].m_in_use && m_sounds[i].m_play_once)
+                    reap_sound(sound_id(i));
+            }
+        }
+
+        update_pending_lengths();
+        enforce_decoded_budget();
+        
+        return false;
+    }
+
+    void MiniAudio::data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
+    {
+        /**
+         * This runs on the audio thread. It must never allocate,
+         * lock, format strings or throw.
+         */
+        
+        /**
+         * Get the instance of the miniaudio pgex for use later
+         * in the callback
+         */
+        MiniAudio* ma = (MiniAudio*)pDevice->pUserData;
+        
+        /**
+         * If the instance of the miniaudio pgex has, for some
+         * reason has not been set, bail. The output buffer is
+         * already silent.
+         */
+        if(ma == nullptr)
+            return;
+
+        if(frameCount > ma->m_max_callback_frames.load(std::memory_order_relaxed))
+            ma->m_max_callback_frames.store(frameCount, std::memory_order_relaxed);
+
+        const auto start = std::chrono::steady_clock::now();
+
+        if(ma->m_last_callback != std::chrono::steady_clock::time_point{})
+        {
+            const ma_uint64 interval = static_cast<ma_uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(start - ma->m_last_callback).count());
+            
+            if(interval > ma->m_max_callback_interval_ns.load(std::memory_order_relaxed))
+                ma->m_max_callback_interval_ns.store(interval, std::memory_order_relaxed);
+        }
+        
+        ma->m_last_callback = start;
+        
+        ma->process_callback(pOutput, frameCount);
+        
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        ma->m_callback_stats.Record(static_cast<ma_uint64>(elapsed.count()), frameCount, ma->m_config.sampleRate);
+    }
+
+    void MiniAudio::process_callback(void* pOutput, const ma_uint32 frameCount)
+    {
+        /**
+         * carry out everything the game thread has asked for since
+         * the last callback, even if we're about to bail. this keeps
+         * the queue moving while the app is out of focus.
+         */
+        Command command;
+        while(m_commands.Pop(command))
+            process_command(command);
+
+        update_generator_nodes();
+
+        /**
+         * If background playback isn't enabled and the app
+         * does not have focus, bail
+         */
+        if(!m_config.offline && !MiniAudio::m_background_playback && !pge->IsFocused())
+            return;
+
+        /**
+         * Mix in chunks no larger than the preallocated buffers, in
+         * case the backend ever hands us more than we planned for.
+         */
+        ma_uint8* output = static_cast<ma_uint8*>(pOutput);
+        ma_uint32 framesMixed = 0;
+
+        while(framesMixed < frameCount)
+        {
+            const ma_uint32 framesToMix = std::min(frameCount - framesMixed, m_mix_buffer_frames);
+            
+            mix(output + (framesMixed * m_output_frame_bytes), framesToMix);
+            framesMixed += framesToMix;
+        }
+    }
+
+    void MiniAudio::mix(void* pOutput, const ma_uint32 frameCount)
+    {
+        /**
+         * Note:    m_engine_buffer is the buffer the engine mixes into
+         *          prior to copying it to the final output buffer.
+         */
+        const size_t sampleCount = static_cast<size_t>(frameCount) * m_config.channels;
+
+        /**
+         * the waveforms, the synth and the noise callback are nodes in
+         * the engine's graph, they're mixed in along with the sounds.
+         * they count the frames they make from the engine's clock.
+         */
+        const ma_uint64 clock = ma_engine_get_time_in_pcm_frames(&m_engine);
+        m_waveform_node.m_clock = clock;
+        m_synth_node.m_clock = clock;
+        m_noise_node.m_clock = clock;
+
+        /**
+         * read pcm frames from the engine to the buffer
+         */
+        ma_engine_read_pcm_frames(&m_engine, m_engine_buffer.data(), frameCount, NULL);
+
+        /**
+         * clamp the output to a range of -1.0f to 1.0f
+         */
+        Kernels::Clamp(m_engine_buffer.data(), sampleCount, m_kernel_path);
+
+        /**
+         * Copy the results to the output buffer, converting them if
+         * the device wants something other than f32
+         */
+        if(m_config.format == ma_format_f32)
+            memcpy(pOutput, m_engine_buffer.data(), sampleCount * sizeof(float));
+        else
+            ma_convert_pcm_frames_format(pOutput, m_config.format, m_engine_buffer.data(), ma_format_f32, frameCount, m_config.channels, ma_dither_mode_none);
+    }
+
+    void MiniAudio::SetBackgroundPlay(bool state)
+    {
+        MiniAudio::m_background_playback = state;
+    }
+
+    void MiniAudio::SetStreamThreshold(const std::uintmax_t bytes)
+    {
+        m_stream_threshold = bytes;
+    }
+
+    const int MiniAudio::LoadSound(const std::string& path, olc::ResourcePack* pack, bool playOnce, const LoadMode mode, const int bus)
+    {
+        return load_sound(path, pack, playOnce, mode, nullptr, bus);
+    }
+
+    const int MiniAudio::load_sound(const std::string& path, olc::ResourcePack* pack, const bool playOnce, const LoadMode mode, ma_fence* pFence, const int bus)
+    {
+        ma_sound_group* group = bus_group(bus);
+        bool stream = false;
+        
+        /**
+         * packed files are read through the pack file system. files on
+         * disk are opened by the resource manager, either streamed a
+         * page at a time or decoded once into data every sound of the
+         * path shares
+         */
+        if(pack != nullptr)
+        {
+            stream = acquire_pack_file(path, pack, mode);
+        }
+        else if(!should_stream(path, mode))
+        {
+            acquire_sound_file(path, nullptr);
+        }
+        else
+        {
+            stream = true;
+        }
+        
+        int id = allocate_sound_slot();
+        Sound& sound = get_sound(id);
+
+        /**
+         * a stream is opened synchronously, it only decodes its first
+         * page up front and that makes its length known straight away
+         */
+        ma_uint32 flags = (stream) ? MA_SOUND_FLAG_STREAM : (MA_SOUND_FLAG_DECODE | MA_SOUND_FLAG_ASYNC);
+
+        if(ma_sound_init_from_file(&m_engine, path.c_str(), flags, group, pFence, &sound.m_sound) != MA_SUCCESS)
+        {
+            release_sound_file(path, pack != nullptr, stream);
+            release_sound_slot(id);
+            throw std::runtime_error{"PGEX_MiniAudio: failed to initialize a sound"};
+        }
+        
+        sound.m_streamed = stream;
+        sound.m_pack = pack;
+        sound.m_bus = bus;
+        
+        /**
+         * sounds with the play once flag set will be automatically
+         * unloaded when it has finished it's playback.
+         */
+        sound.m_play_once = playOnce;
+        sound.m_owner = this;
+        sound.m_id = id;
+
+        if(playOnce)
+            ma_sound_set_end_callback(&sound.m_sound, MiniAudio::sound_end_callback, &sound);
+
+        /**
+         * used to let go of the sound's file and decoded data later
+         */
+        sound.m_path = path;
+
+        /**
+         * asking for the length waits for the sound to finish loading,
+         * it's cached once it has instead, without holding anyone up
+         */
+        if(!stream)
+        {
+            track_decoded(path, 0, false);
+            touch_decoded(path);
+        }
+        
+        if(!update_length(sound))
+            m_pending_lengths.push_back(id);
+        
+        PGEX_MA_LOG(sound.string());
+        return id;
+    }
+
+    void MiniAudio::UnloadSound(const int id)
+    {
+        Sound& sound = get_sound(id);
+        
+        /**
+         * an evicted sound has already let go of everything
+         */
+        if(sound.m_evicted)
+        {
+            release_sound_slot(id);
+            return;
+        }
+        
+        /**
+         * if the sound is playing, stop it
+         */
+        if(ma_sound_is_playing(&sound.m_sound))
+            ma_sound_stop(&sound.m_sound);
+        
+        /**
+         * let miniaudio perform it's uninitialization on the sound
+         */
+        ma_sound_uninit(&sound.m_sound);
+
+        /**
+         * let go of the sound's file, however it was loaded
+         */
+        release_sound_file(sound.m_path, sound.m_pack != nullptr, sound.m_streamed);
+
+        if(!sound.m_streamed)
+            untrack_decoded(sound.m_path, false);
+
+        /**
+         * mark this slot as empty, the id is stale from here on
+         */
+        release_sound_slot(id);
+    }
+
+    const int MiniAudio::LoadSoundBank(const std::string& path, const int voices, olc::ResourcePack* pack, const int bus)
+    {
+        if(voices < 1)
+            throw std::runtime_error{std::format("PGEX_MiniAudio: a sound bank needs at least one voice, got {}", voices)};
+
+        ma_sound_group* group = bus_group(bus);
+
+        /**
+         * look for an empty slot for re-use, or make a new one
+         */
+        int id = -1;
+        for(int i = 0; i < m_sound_banks.size(); i++)
+        {
+            if(!m_sound_banks.at(i).m_loaded)
+            {
+                id = i;
+                break;
+            }
+        }
+
+        if(id == -1)
+        {
+            id = static_cast<int>(m_sound_banks.size());
+            m_sound_banks.emplace_back();
+        }
+
+        acquire_sound_file(path, pack);
+
+        SoundBank& bank = m_sound_banks.at(id);
+        bank.m_voices = std::make_unique<ma_sound[]>(voices);
+        bank.m_voice_count = voices;
+        bank.m_next_voice = 0;
+        bank.m_path = path;
+        bank.m_packed = (pack != nullptr);
+        bank.m_bus = bus;
+
+        /**
+         * decode the first voice up front, so the bank is ready to
+         * fire the moment this returns. the resource manager decodes
+         * the file once into data of its own
+         */
+        if(ma_sound_init_from_file(&m_engine, path.c_str(), MA_SOUND_FLAG_DECODE, group, NULL, &bank.m_voices[0]) != MA_SUCCESS)
+        {
+            release_sound_file(path, pack != nullptr, false);
+            bank = SoundBank{};
+            throw std::runtime_error{"PGEX_MiniAudio: failed to initialize a sound bank"};
+        }
+
+        /**
+         * the rest of the voices are copies, they read the first
+         * voice's decoded data rather than decoding it again
+         */
+        for(int i = 1; i < voices; i++)
+        {
+            if(ma_sound_init_copy(&m_engine, &bank.m_voices[0], 0, group, &bank.m_voices[i]) != MA_SUCCESS)
+            {
+                for(int j = 0; j < i; j++)
+                    ma_sound_uninit(&bank.m_voices[j]);
+
+                release_sound_file(path, pack != nullptr, false);
+                bank = SoundBank{};
+                throw std::runtime_error{"PGEX_MiniAudio: failed to initialize a sound bank voice"};
+            }
+        }
+
+        ma_uint64 frames = 0;
+        ma_sound_get_length_in_pcm_frames(&bank.m_voices[0], &frames);
+        track_decoded(path, frames, true);
+
+        bank.m_loaded = true;
+        
+        PGEX_MA_LOG(std::format("{}, voices({})", path, voices));
+        return id;
+    }
+
+    void MiniAudio::UnloadSoundBank(const int id)
+    {
+        SoundBank& bank = m_sound_banks.at(id);
+
+        if(!bank.m_loaded)
+            throw std::runtime_error{std::format("tried to unload non-existent sound bank at id({})", id)};
+
+        for(int i = 0; i < bank.m_voice_count; i++)
+        {
+            ma_sound_stop(&bank.m_voices[i]);
+            ma_sound_uninit(&bank.m_voices[i]);
+        }
+
+        release_sound_file(bank.m_path, bank.m_packed, false);
+        untrack_decoded(bank.m_path, true);
+
+        bank = SoundBank{};
+    }
+
+    void MiniAudio::PlaySoundBank(const int id, const float volume, const float pan, const float pitch)
+    {
+        SoundBank& bank = m_sound_banks.at(id);
+
+        if(!bank.m_loaded)
+            throw std::runtime_error{std::format("tried to play non-existent sound bank at id({})", id)};
+
+        /**
+         * voices are handed out round robin, so the next voice is
+         * always the one started longest ago. if it's still playing,
+         * it gets restarted.
+         */
+        ma_sound* voice = &bank.m_voices[bank.m_next_voice];
+        bank.m_next_voice = (bank.m_next_voice + 1) % bank.m_voice_count;
+
+        ma_sound_set_volume(voice, std::clamp(volume, 0.0f, 1.0f));
+        ma_sound_set_pan(voice, std::clamp(pan, -1.0f, 1.0f));
+        ma_sound_set_pitch(voice, std::max({0.0f, pitch}));
+        ma_sound_seek_to_pcm_frame(voice, 0);
+        ma_sound_start(voice);
+    }
+
+    void MiniAudio::Play(const int id, const bool looping)
+    {
+        Sound& sound = resident_sound(id);
+        
+        if(ma_sound_is_playing(&sound.m_sound))
+            return;
+        
+        if(looping)
+            ma_sound_set_looping(&sound.m_sound, true);
+        
+        clear_schedule(sound);
+        ma_sound_start(&sound.m_sound);
+        
+        if(!sound.m_streamed)
+            touch_decoded(sound.m_path);
+    }
+
+    void MiniAudio::PlayAt(const int id, const ma_uint64 engineFrame, const bool looping)
+    {
+        Sound& sound = resident_sound(id);
+        
+        if(looping)
+            ma_sound_set_looping(&sound.m_sound, true);
+
+        /**
+         * miniaudio holds the sound back until the engine's clock
+         * reaches the start time, and starts it part way into a block
+         */
+        clear_schedule(sound);
+        ma_sound_set_start_time_in_pcm_frames(&sound.m_sound, engineFrame);
+        ma_sound_start(&sound.m_sound);
+        
+        if(!sound.m_streamed)
+            touch_decoded(sound.m_path);
+    }
+
+    void MiniAudio::StopAt(const int id, const ma_uint64 engineFrame)
+    {
+        /**
+         * an evicted sound keeps the stop for when it's restored
+         */
+        if(get_sound(id).m_evicted)
+        {
+            get_sound(id).m_saved_stop_frame = engineFrame;
+            return;
+        }
+        
+        ma_sound_set_stop_time_in_pcm_frames(&get_sound(id).m_sound, engineFrame);
+    }
+    
+    const int MiniAudio::Play(const std::string& path, olc::ResourcePack* pack, const int bus)
+    {
+        int id = LoadSound(path, pack, true, LoadMode::Auto, bus);
+        ma_sound_start(&get_sound(id).m_sound);
+        m_count_play_once_sounds++;
+        return id;
+    }
+
+    void MiniAudio::Stop(const int id)
+    {
+        /**
+         * an evicted sound isn't playing, just rewind what it'll be restored to
+         */
+        if(get_sound(id).m_evicted)
+        {
+            get_sound(id).m_saved_cursor = 0;
+            return;
+        }
+        
+        if(!ma_sound_is_playing(&get_sound(id).m_sound) && !is_scheduled(get_sound(id)))
+            return;
+        
+        ma_sound_stop(&get_sound(id).m_sound);
+        ma_sound_seek_to_pcm_frame(&get_sound(id).m_sound, 0);
+    }
+
+    void MiniAudio::Pause(const int id)
+    {
+        if(get_sound(id).m_evicted)
+            return;
+        
+        if(!ma_sound_is_playing(&get_sound(id).m_sound) && !is_scheduled(get_sound(id)))
+            return;
+        
+        ma_sound_stop(&get_sound(id).m_sound);
+    }
+
+    void MiniAudio::Toggle(const int id)
+    {
+        Sound& sound = resident_sound(id);
+        
+        if(ma_sound_is_playing(&sound.m_sound) || is_scheduled(sound))
+        {
+            ma_sound_stop(&sound.m_sound);
+            return;
+        }
+        
+        clear_schedule(sound);
+        ma_sound_start(&sound.m_sound);
+        
+        if(!sound.m_streamed)
+            touch_decoded(sound.m_path);
+    }
+
+    void MiniAudio::Seek(const int id, const ma_uint64 milliseconds)
+    {
+        ma_uint64 frame_to_seek_to = (milliseconds * m_config.sampleRate) / 1000;
+        ma_sound_seek_to_pcm_frame(&resident_sound(id).m_sound, frame_to_seek_to);
+    }
+
+    void MiniAudio::Seek(const int id, const float& location)
+    {
+        Sound& sound = resident_sound(id);
+        
+        // this one can't wait, ask for the length now even if it means blocking
+        ma_uint64 length = sound.m_length_in_pcm_frames;
+        if(!sound.m_length_known)
+            ma_sound_get_length_in_pcm_frames(&sound.m_sound, &length);
+        
+        ma_uint64 frame_to_seek_to = static_cast<ma_uint64>(length * location);
+        ma_sound_seek_to_pcm_frame(&resident_sound(id).m_sound, frame_to_seek_to);
+    }
+
+    void MiniAudio::Forward(const int id, const ma_uint64 milliseconds)
+    {
+        ma_uint64 frame_to_seek_to;
+
+        // get the current position
+        ma_sound_get_cursor_in_pcm_frames(&resident_sound(id).m_sound, &frame_to_seek_to);
+        
+        // calculate the step and add it to the current position
+        frame_to_seek_to += ((milliseconds * m_config.sampleRate) / 1000);
+
+        // seek to the new position
+        ma_sound_seek_to_pcm_frame(&resident_sound(id).m_sound, frame_to_seek_to);
+    }
+
+    void MiniAudio::Rewind(const int id, const ma_uint64 milliseconds)
+    {
+        ma_uint64 frame_to_seek_to;
+
+        // get the current position
+        ma_sound_get_cursor_in_pcm_frames(&resident_sound(id).m_sound, &frame_to_seek_to);
+        
+        // calculate the step and subtract it to the current position, stopping at the beginning
+        ma_uint64 step = ((milliseconds * m_config.sampleRate) / 1000);
+        frame_to_seek_to = (step < frame_to_seek_to) ? frame_to_seek_to - step : 0;
+
+        // seek to the new position
+        ma_sound_seek_to_pcm_frame(&resident_sound(id).m_sound, frame_to_seek_to);
+    }
+
+    void MiniAudio::SetVolume(const int id, const float& volume)
+    {
+        if(get_sound(id).m_evicted)
+        {
+            get_sound(id).m_saved_volume = std::clamp(volume, 0.0f, 1.0f);
+            return;
+        }
+        
+        ma_sound_set_volume(&get_sound(id).m_sound, std::clamp(volume, 0.0f, 1.0f));
+    }
+
+    void MiniAudio::SetPan(const int id, const float& pan)
+    {
+        if(get_sound(id).m_evicted)
+        {
+            get_sound(id).m_saved_pan = std::clamp(pan, -1.0f, 1.0f);
+            return;
+        }
+        
+        ma_sound_set_pan(&get_sound(id).m_sound, std::clamp(pan, -1.0f, 1.0f));
+    }
+
+    void MiniAudio::SetPitch(const int id, const float& pitch)
+    {
+        if(get_sound(id).m_evicted)
+        {
+            get_sound(id).m_saved_pitch = std::max({0.0f, pitch});
+            return;
+        }
+        
+        ma_sound_set_pitch(&get_sound(id).m_sound, std::max({0.0f, pitch}));
+    }
+
+    bool MiniAudio::IsPlaying(const int id)
+    {
+        if(get_sound(id).m_evicted)
+            return false;
+        
+        if(ma_sound_is_playing(&get_sound(id).m_sound))
+            return true;
+        
+        return false;
+    }
+    
+    ma_uint64 MiniAudio::GetCursorMilliseconds(const int id)
+    {
+        ma_uint64 cursor = get_sound(id).m_saved_cursor;
+        
+        if(!get_sound(id).m_evicted)
+            ma_sound_get_cursor_in_pcm_frames(&get_sound(id).m_sound, &cursor);
+        
+        return (cursor * 1000) / m_config.sampleRate;
+    }
+    
+    float MiniAudio::GetCursorFloat(const int id)
+    {
+        float cursor = static_cast<float>(get_sound(id).m_saved_cursor) / m_config.sampleRate;
+        
+        if(!get_sound(id).m_evicted)
+            ma_sound_get_cursor_in_seconds(&get_sound(id).m_sound, &cursor);
+        
+        // still loading, or a streamed format that can't tell how long it is
+        if(!update_length(get_sound(id)) || get_sound(id).m_length_in_seconds <= 0.0f)
+            return 0.0f;
+        
+        return cursor / get_sound(id).m_length_in_seconds;
+    }
+
+    int MiniAudio::GetOneOffCount()
+    {
+        return m_count_play_once_sounds;
+    }
+
+    const int MiniAudio::CreateBus(const int parent)
+    {
+        ma_sound_group* parentGroup = bus_group(parent);
+
+        /**
+         * look for an empty slot for re-use, or make a new one
+         */
+        int id = -1;
+        for(int i = 0; i < m_buses.size(); i++)
+        {
+            if(!m_buses[i].m_in_use)
+            {
+                id = i;
+                break;
+            }
+        }
+
+        if(id == -1)
+        {
+            id = static_cast<int>(m_buses.size());
+            m_buses.emplace_back();
+        }
+
+        Bus& bus = m_buses[id];
+
+        if(ma_sound_group_init(&m_engine, 0, parentGroup, &bus.m_group) != MA_SUCCESS)
+            throw std::runtime_error{"PGEX_MiniAudio: failed to initialize a bus"};
+
+        bus.m_parent = parent;
+        bus.m_in_use = true;
+
+        PGEX_MA_LOG(std::format("bus({}) feeding into bus({})", id, parent));
+        return id;
+    }
+
+    void MiniAudio::UnloadBus(const int id)
+    {
+        Bus& bus = get_bus(id);
+        ma_node* parent = bus_node(bus.m_parent);
+
+        /**
+         * hand everything feeding into this bus over to its parent,
+         * nothing goes quiet just because its bus went away
+         */
+        for(int i = 0; i < m_buses.size(); i++)
+        {
+            if(m_buses[i].m_in_use && m_buses[i].m_parent == id)
+            {
+                ma_node_attach_output_bus(&m_buses[i].m_group, 0, parent, 0);
+                m_buses[i].m_parent = bus.m_parent;
+            }
+        }
+
+        for(Sound& sound : m_sounds)
+        {
+            if(!sound.m_in_use || sound.m_bus != id)
+                continue;
+
+            if(!sound.m_evicted)
+                ma_node_attach_output_bus(&sound.m_sound, 0, parent, 0);
+
+            sound.m_bus = bus.m_parent;
+        }
+
+        for(SoundBank& bank : m_sound_banks)
+        {
+            if(!bank.m_loaded || bank.m_bus != id)
+                continue;
+
+            for(int i = 0; i < bank.m_voice_count; i++)
+                ma_node_attach_output_bus(&bank.m_voices[i], 0, parent, 0);
+
+            bank.m_bus = bus.m_parent;
+        }
+
+        for(GeneratorNode* node : {&m_waveform_node, &m_synth_node, &m_noise_node})
+        {
+            if(node->m_bus == id)
+                set_generator_bus(*node, bus.m_parent);
+        }
+
+        ma_sound_group_uninit(&bus.m_group);
+        bus = Bus{};
+    }
+
+    void MiniAudio::SetSoundBus(const int soundId, const int busId)
+    {
+        Sound& sound = get_sound(soundId);
+        ma_node* node = bus_node(busId);
+
+        /**
+         * an evicted sound is attached to its bus when it's restored
+         */
+        if(!sound.m_evicted)
+            ma_node_attach_output_bus(&sound.m_sound, 0, node, 0);
+
+        sound.m_bus = busId;
+    }
+
+    void MiniAudio::SetBusVolume(const int id, const float& volume)
+    {
+        ma_sound_group_set_volume(&get_bus(id).m_group, std::clamp(volume, 0.0f, 1.0f));
+    }
+
+    void MiniAudio::SetBusPan(const int id, const float& pan)
+    {
+        ma_sound_group_set_pan(&get_bus(id).m_group, std::clamp(pan, -1.0f, 1.0f));
+    }
+
+    void MiniAudio::SetBusPitch(const int id, const float& pitch)
+    {
+        ma_sound_group_set_pitch(&get_bus(id).m_group, std::max({0.0f, pitch}));
+    }
+
+    void MiniAudio::PauseBus(const int id)
+    {
+        /**
+         * a stopped group stops pulling from its inputs, so they
+         * stay exactly where they were until it starts again
+         */
+        ma_sound_group_stop(&get_bus(id).m_group);
+    }
+
+    void MiniAudio::ResumeBus(const int id)
+    {
+        ma_sound_group_start(&get_bus(id).m_group);
+    }
+
+    bool MiniAudio::IsBusPaused(const int id)
+    {
+        return !ma_sound_group_is_playing(&get_bus(id).m_group);
+    }
+
+    ma_sound_group* MiniAudio::GetBus(const int id)
+    {
+        return &get_bus(id).m_group;
+    }
+
+    MiniAudio::Bus& MiniAudio::get_bus(const int id)
+    {
+        if(id < 0 || id >= m_buses.size() || !m_buses[id].m_in_use)
+            throw std::runtime_error{std::format("invalid bus id({})", id)};
+
+        return m_buses[id];
+    }
+
+    ma_sound_group* MiniAudio::bus_group(const int id)
+    {
+        if(id == MASTER_BUS)
+            return nullptr;
+
+        return &get_bus(id).m_group;
+    }
+
+    ma_node* MiniAudio::bus_node(const int id)
+    {
+        if(id == MASTER_BUS)
+            return ma_engine_get_endpoint(&m_engine);
+
+        return &get_bus(id).m_group;
+    }
+
+    const int MiniAudio::CreateWaveform(const double amplitude, const double frequency, const ma_waveform_type waveformType, const bool bandLimited)
+    {
+        int id = -1;
+        
+        // attempt to re-use an empty slot
+        for(int i = 0; i < m_waveform_infos.size(); i++)
+        {
+            if(!m_waveform_infos.at(i).m_is_loaded)
+            {
+                id = i;
+                break;
+            }
+        }
+
+        // no empty slots, make more room!
+        if(id == -1)
+        {
+            if(m_waveform_infos.size() == m_oscillators.Capacity())
+                throw std::runtime_error{std::format("PGEX_MiniAudio: can not create more than {} waveforms", m_oscillators.Capacity())};
+
+            id = static_cast<int>(m_waveform_infos.size());
+            m_waveform_infos.emplace_back();
+        }
+
+        m_waveform_infos.at(id) = WaveformInfo{amplitude, frequency, waveformType, bandLimited, false, true, false};
+
+        Command command;
+        command.m_type = Command::Type::CreateWaveform;
+        command.m_id = id;
+        command.m_amplitude = amplitude;
+        command.m_frequency = frequency;
+        command.m_waveform_type = waveformType;
+        command.m_band_limited = bandLimited;
+        send_command(command);
+        
+        return id;
+    }
+
+    void MiniAudio::PlayWaveform(const int id)
+    {
+        if(m_waveform_infos.at(id).m_is_playing && !m_waveform_infos.at(id).m_is_scheduled)
+            return;
+
+        m_waveform_infos.at(id).m_is_playing = true;
+        m_waveform_infos.at(id).m_is_scheduled = false;
+        
+        Command command;
+        command.m_type = Command::Type::PlayWaveform;
+        command.m_id = id;
+        send_command(command);
+    }
+
+    void MiniAudio::PlayWaveformAt(const int id, const ma_uint64 engineFrame)
+    {
+        m_waveform_infos.at(id).m_is_playing = true;
+        m_waveform_infos.at(id).m_is_scheduled = true;
+
+        Command command;
+        command.m_type = Command::Type::PlayWaveformAt;
+        command.m_id = id;
+        command.m_frame = engineFrame;
+        send_command(command);
+    }
+
+    void MiniAudio::StopWaveformAt(const int id, const ma_uint64 engineFrame)
+    {
+        m_waveform_infos.at(id).m_is_playing = false;
+        m_waveform_infos.at(id).m_is_scheduled = true;
+
+        Command command;
+        command.m_type = Command::Type::StopWaveformAt;
+        command.m_id = id;
+        command.m_frame = engineFrame;
+        send_command(command);
+    }
+
+    void MiniAudio::SetWaveformAmplitude(const int id, const double amplitude)
+    {
+        if(m_waveform_infos.at(id).m_amplitude == amplitude)
+            return;
+
+        m_waveform_infos.at(id).m_amplitude = amplitude;
+
+        Command command;
+        command.m_type = Command::Type::SetWaveformAmplitude;
+        command.m_id = id;
+        command.m_amplitude = amplitude;
+        send_command(command);
+    }
+
+    void MiniAudio::SetWaveformFrequency(const int id, const double frequency)
+    {
+        if(m_waveform_infos.at(id).m_frequency == frequency)
+            return;
+
+        m_waveform_infos.at(id).m_frequency = frequency;
+
+        Command command;
+        command.m_type = Command::Type::SetWaveformFrequency;
+        command.m_id = id;
+        command.m_frequency = frequency;
+        send_command(command);
+    }
+
+    void MiniAudio::SetWaveformType(const int id, const ma_waveform_type waveformType)
+    {
+        if(m_waveform_infos.at(id).m_type == waveformType)
+            return;
+
+        m_waveform_infos.at(id).m_type = waveformType;
+
+        Command command;
+        command.m_type = Command::Type::SetWaveformType;
+        command.m_id = id;
+        command.m_waveform_type = waveformType;
+        send_command(command);
+    }
+
+    void MiniAudio::SetWaveformBandLimited(const int id, const bool bandLimited)
+    {
+        if(m_waveform_infos.at(id).m_band_limited == bandLimited)
+            return;
+
+        m_waveform_infos.at(id).m_band_limited = bandLimited;
+
+        Command command;
+        command.m_type = Command::Type::SetWaveformBandLimited;
+        command.m_id = id;
+        command.m_band_limited = bandLimited;
+        send_command(command);
+    }
+
+    void MiniAudio::StopWaveform(const int id)
+    {
+        if(!m_waveform_infos.at(id).m_is_playing && !m_waveform_infos.at(id).m_is_scheduled)
+            return;
+        
+        m_waveform_infos.at(id).m_is_playing = false;
+        m_waveform_infos.at(id).m_is_scheduled = false;
+
+        Command command;
+        command.m_type = Command::Type::StopWaveform;
+        command.m_id = id;
+        send_command(command);
+    }
+
+    void MiniAudio::UnloadWaveform(const int id)
+    {
+        m_waveform_infos.at(id) = WaveformInfo{};
+
+        Command command;
+        command.m_type = Command::Type::UnloadWaveform;
+        command.m_id = id;
+        send_command(command);
+    }
+
+    const bool MiniAudio::IsWaveformPlaying(const int id)
+    {
+        return m_waveform_infos.at(id).m_is_playing;
+    }
+
+    const double& MiniAudio::GetWaveformAmplitude(const int id)
+    {
+        return m_waveform_infos.at(id).m_amplitude;
+    }
+
+    const double& MiniAudio::GetWaveformFrequency(const int id)
+    {
+        return m_waveform_infos.at(id).m_frequency;
+    }
+
+    const ma_waveform_type& MiniAudio::GetWaveformType(const int id)
+    {
+        return m_waveform_infos.at(id).m_type;
+    }
+
+    const bool MiniAudio::IsWaveformBandLimited(const int id)
+    {
+        return m_waveform_infos.at(id).m_band_limited;
+    }
+
+    const int MiniAudio::CreateInstrument(const Instrument& instrument)
+    {
+        int id = -1;
+
+        // attempt to re-use an empty slot
+        for(int i = 0; i < m_instrument_infos.size(); i++)
+        {
+            if(!m_instrument_infos.at(i).m_is_loaded)
+            {
+                id = i;
+                break;
+            }
+        }
+
+        if(id == -1)
+        {
+            if(m_instrument_infos.size() == m_synth.InstrumentCapacity())
+                throw std::runtime_error{std::format("PGEX_MiniAudio: can not create more than {} instruments", m_synth.InstrumentCapacity())};
+
+            id = static_cast<int>(m_instrument_infos.size());
+            m_instrument_infos.emplace_back();
+        }
+
+        m_instrument_infos.at(id).m_is_loaded = true;
+        SetInstrument(id, instrument);
+
+        return id;
+    }
+
+    void MiniAudio::SetInstrument(const int id, const Instrument& instrument)
+    {
+        get_instrument(id).m_instrument = instrument;
+
+        /**
+         * too big to travel inside a command, the audio thread copies
+         * it and hands it back to be freed
+         */
+        Command command;
+        command.m_type = Command::Type::SetInstrument;
+        command.m_id = id;
+        command.m_instrument = new Instrument{instrument};
+        send_command(command);
+    }
+
+    void MiniAudio::UnloadInstrument(const int id)
+    {
+        get_instrument(id) = InstrumentInfo{};
+
+        Command command;
+        command.m_type = Command::Type::UnloadInstrument;
+        command.m_id = id;
+        send_command(command);
+    }
+
+    const MiniAudio::Instrument& MiniAudio::GetInstrument(const int id)
+    {
+        return get_instrument(id).m_instrument;
+    }
+
+    const int MiniAudio::NoteOn(const int instrument, const float frequency, const float velocity)
+    {
+        get_instrument(instrument);
+
+        const int note = m_next_note;
+        m_next_note = (m_next_note + 1) & 0x7fffffff;
+
+        Command command;
+        command.m_type = Command::Type::NoteOn;
+        command.m_id = note;
+        command.m_instrument_id = instrument;
+        command.m_frequency = frequency;
+        command.m_amplitude = velocity;
+        send_command(command);
+
+        return note;
+    }
+
+    void MiniAudio::NoteOff(const int note)
+    {
+        Command command;
+        command.m_type = Command::Type::NoteOff;
+        command.m_id = note;
+        send_command(command);
+    }
+
+    void MiniAudio::AllNotesOff()
+    {
+        Command command;
+        command.m_type = Command::Type::AllNotesOff;
+        send_command(command);
+    }
+
+    int MiniAudio::GetActiveVoiceCount()
+    {
+        return m_active_voices.load(std::memory_order_relaxed);
+    }
+
+    MiniAudio::InstrumentInfo& MiniAudio::get_instrument(const int id)
+    {
+        if(id < 0 || id >= m_instrument_infos.size() || !m_instrument_infos[id].m_is_loaded)
+            throw std::runtime_error{std::format("invalid instrument id({})", id)};
+
+        return m_instrument_infos[id];
+    }
+
+    void MiniAudio::SetNoiseCallback(std::function<void(float& noiseLeftChannel, float& noiseRightChannel, const float fElapsedTime)>callbackFunc)
+    {
+        if(!callbackFunc)
+        {
+            ClearNoiseCallback();
+            return;
+        }
+
+        /**
+         * adapt the per-sample callback to the block callback, the
+         * channel values persist between calls like they always have
+         */
+        SetNoiseBlockCallback([callbackFunc, left = 0.0f, right = 0.0f, elapsed = 1.0f / m_config.sampleRate](float* noiseData, const ma_uint32 frameCount, const ma_uint32 channels, const ma_uint64 frameClock) mutable
+        {
+            for(ma_uint32 i = 0; i < frameCount; i++)
+            {
+                callbackFunc(left, right, elapsed);
+
+                /**
+                 * a mono device gets both channels folded together,
+                 * anything past stereo is left silent
+                 */
+                if(channels == 1)
+                {
+                    noiseData[i] = (left + right) * 0.5f;
+                    continue;
+                }
+
+                noiseData[(i * channels)] = left;
+                noiseData[(i * channels) + 1] = right;
+            }
+        });
+    }
+
+    void MiniAudio::SetNoiseBlockCallback(std::function<void(float* noiseData, const ma_uint32 frameCount, const ma_uint32 channels, const ma_uint64 frameClock)>callbackFunc)
+    {
+        // make room for the callback this one will replace
+        collect_garbage();
+
+        Command command;
+        command.m_type = Command::Type::SetNoiseCallback;
+        
+        /**
+         * the audio thread takes ownership of the copy and hands it
+         * back to us to delete when it's replaced
+         */
+        if(callbackFunc)
+            command.m_noise_callback = new NoiseBlockCallback(std::move(callbackFunc));
+
+        send_command(command);
+    }
+
+    void MiniAudio::ClearNoiseCallback()
+    {
+        SetNoiseBlockCallback({});
+    }
+
+    ma_uint64 MiniAudio::GetEngineTimeInFrames()
+    {
+        return ma_engine_get_time_in_pcm_frames(&m_engine);
+    }
+
+    const MiniAudio::Config& MiniAudio::GetConfig()
+    {
+        return m_config;
+    }
+
+    MiniAudio::Latency MiniAudio::GetOutputLatency()
+    {
+        Latency latency;
+        
+        // nothing stands between Render and its caller
+        if(m_config.offline)
+            return latency;
+        
+        /**
+         * the periods are counted at the device's internal rate, bring
+         * them over to ours before adding what the resampler holds back
+         */
+        ma_uint64 periodFrames = m_device.playback.internalPeriodSizeInFrames;
+        
+        if(m_device.playback.internalSampleRate != 0)
+            periodFrames = (periodFrames * m_config.sampleRate) / m_device.playback.internalSampleRate;
+
+        const ma_uint64 converterFrames = ma_data_converter_get_output_latency(&m_device.playback.converter);
+        const ma_uint32 periods = std::max<ma_uint32>(m_device.playback.internalPeriods, 1);
+
+        latency.configuredFrames = static_cast<ma_uint32>(periodFrames * periods + converterFrames);
+        latency.configuredMilliseconds = (latency.configuredFrames * 1000.0f) / m_config.sampleRate;
+
+        /**
+         * nothing to go on until the device has called back at least
+         * once. miniaudio doesn't report the backend's own latency, so
+         * this is still an estimate, what's really measured is the
+         * time between callbacks
+         */
+        const ma_uint32 callbackFrames = m_max_callback_frames.load(std::memory_order_relaxed);
+        
+        if(callbackFrames != 0)
+        {
+            latency.estimatedFrames = static_cast<ma_uint32>(static_cast<ma_uint64>(callbackFrames) * periods + converterFrames);
+            latency.estimatedMilliseconds = (latency.estimatedFrames * 1000.0f) / m_config.sampleRate;
+        }
+
+        latency.callbackIntervalMilliseconds = m_max_callback_interval_ns.load(std::memory_order_relaxed) / 1.0e6f;
+
+        return latency;
+    }
+
+    void MiniAudio::Render(float* pOutput, const ma_uint64 frameCount)
+    {
+        if(!m_config.offline)
+            throw std::runtime_error{"PGEX_MiniAudio: Render is only available in offline mode"};
+
+        /**
+         * stand in for the audio thread, a block at a time, just like
+         * a device asking for a period at a time
+         */
+        ma_uint64 framesRendered = 0;
+
+        while(framesRendered < frameCount)
+        {
+            const ma_uint32 framesToRender = static_cast<ma_uint32>(std::min<ma_uint64>(frameCount - framesRendered, m_mix_buffer_frames));
+            
+            const auto start = std::chrono::steady_clock::now();
+            
+            process_callback(pOutput + (framesRendered * m_config.channels), framesToRender);
+            
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            m_callback_stats.Record(static_cast<ma_uint64>(elapsed.count()), framesToRender, m_config.sampleRate);
+            
+            framesRendered += framesToRender;
+        }
+    }
+
+    MiniAudio::AudioStats MiniAudio::GetAudioStats()
+    {
+        return m_callback_stats.Snapshot();
+    }
+
+    void MiniAudio::ResetAudioStats()
+    {
+        m_callback_stats.m_reset_requested.store(true, std::memory_order_release);
+    }
+
+    ma_device* MiniAudio::GetDevice()
+    {
+        if(m_config.offline)
+            return nullptr;
+        
+        return &m_device;
+    }
+
+    ma_engine* MiniAudio::GetEngine()
+    {
+        return &m_engine;
+    }
+
+    ma_resource_manager* MiniAudio::GetResourceManager()
+    {
+        return &m_resource_manager;
+    }
+
+    ma_sound* MiniAudio::GetSound(const int id)
+    {
+        if(!is_valid_sound(id))
+            return nullptr;
+        
+        return &resident_sound(id).m_sound;
+    }
+
+    ma_node* MiniAudio::GetWaveformNode()
+    {
+        return &m_waveform_node;
+    }
+
+    ma_node* MiniAudio::GetSynthNode()
+    {
+        return &m_synth_node;
+    }
+
+    ma_node* MiniAudio::GetNoiseNode()
+    {
+        return &m_noise_node;
+    }
+
+    void MiniAudio::SetWaveformBus(const int busId)
+    {
+        set_generator_bus(m_waveform_node, busId);
+    }
+
+    void MiniAudio::SetSynthBus(const int busId)
+    {
+        set_generator_bus(m_synth_node, busId);
+    }
+
+    void MiniAudio::SetNoiseBus(const int busId)
+    {
+        set_generator_bus(m_noise_node, busId);
+    }
+
+    void MiniAudio::init_generator_node(GeneratorNode& node, const ma_node_vtable* vtable)
+    {
+        const ma_uint32 channels = m_config.channels;
+
+        ma_node_config config = ma_node_config_init();
+        config.vtable = vtable;
+        config.pOutputChannels = &channels;
+        // stopped until there's something to play, see update_generator_nodes
+        config.initialState = ma_node_state_stopped;
+
+        if(ma_node_init(ma_engine_get_node_graph(&m_engine), &config, NULL, &node) != MA_SUCCESS)
+            throw std::runtime_error{"PGEX_MiniAudio: failed to initialize a generator node"};
+
+        node.m_owner = this;
+        node.m_bus = MASTER_BUS;
+        ma_node_attach_output_bus(&node, 0, ma_engine_get_endpoint(&m_engine), 0);
+    }
+
+    void MiniAudio::set_generator_bus(GeneratorNode& node, const int busId)
+    {
+        ma_node_attach_output_bus(&node, 0, bus_node(busId), 0);
+        node.m_bus = busId;
+    }
+
+    void MiniAudio::waveform_node_process(ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn, float** ppFramesOut, ma_uint32* pFrameCountOut)
+    {
+        MiniAudio* ma = static_cast<GeneratorNode*>(pNode)->m_owner;
+        const ma_uint32 channels = ma->m_config.channels;
+
+        GeneratorNode* node = static_cast<GeneratorNode*>(pNode);
+
+        std::fill_n(ppFramesOut[0], static_cast<size_t>(*pFrameCountOut) * channels, 0.0f);
+        ma->m_oscillators.Render(ppFramesOut[0], *pFrameCountOut, channels, node->m_clock, ma->m_kernel_path);
+        node->m_clock += *pFrameCountOut;
+    }
+
+    void MiniAudio::synth_node_process(ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn, float** ppFramesOut, ma_uint32* pFrameCountOut)
+    {
+        MiniAudio* ma = static_cast<GeneratorNode*>(pNode)->m_owner;
+        const ma_uint32 channels = ma->m_config.channels;
+
+        std::fill_n(ppFramesOut[0], static_cast<size_t>(*pFrameCountOut) * channels, 0.0f);
+        ma->m_synth.Render(ppFramesOut[0], *pFrameCountOut, channels, ma->m_kernel_path);
+        ma->m_active_voices.store(ma->m_synth.ActiveVoices(), std::memory_order_relaxed);
+    }
+
+    void MiniAudio::noise_node_process(ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn, float** ppFramesOut, ma_uint32* pFrameCountOut)
+    {
+        MiniAudio* ma = static_cast<GeneratorNode*>(pNode)->m_owner;
+        const ma_uint32 channels = ma->m_config.channels;
+
+        std::fill_n(ppFramesOut[0], static_cast<size_t>(*pFrameCountOut) * channels, 0.0f);
+
+        if(ma->m_noise_block_callback == nullptr)
+            return;
+
+        GeneratorNode* node = static_cast<GeneratorNode*>(pNode);
+        (*ma->m_noise_block_callback)(ppFramesOut[0], *pFrameCountOut, channels, node->m_clock);
+        node->m_clock += *pFrameCountOut;
+    }
+
+    void MiniAudio::update_generator_nodes()
+    {
+        /**
+         * the graph skips stopped nodes altogether, so the ones with
+         * nothing to play cost nothing
+         */
+        ma_node_set_state(&m_waveform_node, (m_oscillators.Playing() > 0 || m_oscillators.HasScheduled()) ? ma_node_state_started : ma_node_state_stopped);
+        ma_node_set_state(&m_synth_node, (m_synth.ActiveVoices() > 0) ? ma_node_state_started : ma_node_state_stopped);
+        ma_node_set_state(&m_noise_node, (m_noise_block_callback != nullptr) ? ma_node_state_started : ma_node_state_stopped);
+        
+        m_active_voices.store(m_synth.ActiveVoices(), std::memory_order_relaxed);
+    }
+
+    void MiniAudio::send_command(const Command& command)
+    {
+        if(!m_commands.Push(command))
+        {
+            delete command.m_noise_callback;
+            delete command.m_instrument;
+            throw std::runtime_error{"PGEX_MiniAudio: command queue is full, is the device running?"};
+        }
+    }
+
+    void MiniAudio::process_command(const Command& command)
+    {
+        switch(command.m_type)
+        {
+            case Command::Type::CreateWaveform:
+                m_oscillators.Load(command.m_id, command.m_amplitude, command.m_frequency, command.m_waveform_type, command.m_band_limited, m_config.sampleRate);
+                break;
+
+            case Command::Type::PlayWaveform:
+                m_oscillators.ClearSchedule(command.m_id);
+                m_oscillators.Start(command.m_id);
+                break;
+
+            case Command::Type::StopWaveform:
+                m_oscillators.ClearSchedule(command.m_id);
+                m_oscillators.Stop(command.m_id);
+                break;
+
+            case Command::Type::PlayWaveformAt:
+                m_oscillators.Schedule(command.m_id, command.m_frame, true);
+                break;
+
+            case Command::Type::StopWaveformAt:
+                m_oscillators.Schedule(command.m_id, command.m_frame, false);
+                break;
+
+            case Command::Type::SetWaveformAmplitude:
+                m_oscillators.SetAmplitude(command.m_id, command.m_amplitude);
+                break;
+
+            case Command::Type::SetWaveformFrequency:
+                m_oscillators.SetFrequency(command.m_id, command.m_frequency, m_config.sampleRate);
+                break;
+
+            case Command::Type::SetWaveformType:
+                m_oscillators.SetType(command.m_id, command.m_waveform_type);
+                break;
+
+            case Command::Type::SetWaveformBandLimited:
+                m_oscillators.SetBandLimited(command.m_id, command.m_band_limited);
+                break;
+
+            case Command::Type::UnloadWaveform:
+                m_oscillators.Unload(command.m_id);
+                break;
+
+            case Command::Type::SetNoiseCallback:
+                /**
+                 * never free on the audio thread, hand the old callback
+                 * back to the game thread. the garbage queue has room for
+                 * every command in flight, so the delete is a last resort.
+                 */
+                if(m_noise_block_callback != nullptr && !m_noise_callback_garbage.Push(m_noise_block_callback))
+                    delete m_noise_block_callback;
+
+                m_noise_block_callback = command.m_noise_callback;
+                break;
+
+            case Command::Type::SetInstrument:
+                m_synth.SetInstrument(command.m_id, *command.m_instrument);
+                
+                /**
+                 * it's been copied, hand it back to be freed like the
+                 * noise callbacks
+                 */
+                if(!m_instrument_garbage.Push(command.m_instrument))
+                    delete command.m_instrument;
+                break;
+
+            case Command::Type::UnloadInstrument:
+                m_synth.UnloadInstrument(command.m_id);
+                break;
+
+            case Command::Type::NoteOn:
+                m_synth.NoteOn(command.m_id, command.m_instrument_id, static_cast<float>(command.m_frequency), static_cast<float>(command.m_amplitude));
+                break;
+
+            case Command::Type::NoteOff:
+                m_synth.NoteOff(command.m_id);
+                break;
+
+            case Command::Type::AllNotesOff:
+                m_synth.AllNotesOff();
+                break;
+        }
+    }
+
+    void MiniAudio::collect_garbage()
+    {
+        NoiseBlockCallback* callback;
+        while(m_noise_callback_garbage.Pop(callback))
+            delete callback;
+
+        Instrument* instrument;
+        while(m_instrument_garbage.Pop(instrument))
+            delete instrument;
+    }
+
+    const int MiniAudio::allocate_sound_slot()
+    {
+        int index;
+
+        /**
+         * re-use the most recently freed slot, if there is one
+         */
+        if(!m_free_sound_slots.empty())
+        {
+            index = m_free_sound_slots.back();
+            m_free_sound_slots.pop_back();
+        }
+        else
+        {
+            /**
+             * create a new slot
+             */
+            if(m_sounds.size() > SOUND_INDEX_MASK)
+                throw std::runtime_error{"PGEX_MiniAudio: ran out of sound slots"};
+
+            index = static_cast<int>(m_sounds.size());
+            m_sounds.emplace_back();
+        }
+
+        Sound& sound = m_sounds[index];
+        sound.m_length_in_pcm_frames = 0;
+        sound.m_length_in_seconds = 0;
+        sound.m_length_known = false;
+        sound.m_path.clear();
+        sound.m_play_once = false;
+        sound.m_streamed = false;
+        sound.m_pack = nullptr;
+        sound.m_evicted = false;
+        sound.m_in_use = true;
+
+        return sound_id(index);
+    }
+
+    void MiniAudio::release_sound_slot(const int id)
+    {
+        Sound& sound = get_sound(id);
+        
+        sound.m_in_use = false;
+        sound.m_generation = (sound.m_generation + 1) & SOUND_GENERATION_MASK;
+        
+        m_free_sound_slots.push_back(id & SOUND_INDEX_MASK);
+    }
+
+    MiniAudio::Sound& MiniAudio::get_sound(const int id)
+    {
+        const int index = id & SOUND_INDEX_MASK;
+        const int generation = (id >> SOUND_INDEX_BITS) & SOUND_GENERATION_MASK;
+
+        if(id < 0 || index >= m_sounds.size())
+            throw std::runtime_error{std::format("invalid sound id({})", id)};
+
+        Sound& sound = m_sounds[index];
+
+        if(!sound.m_in_use || sound.m_generation != generation)
+            throw std::runtime_error{std::format("stale sound id({}), the sound was unloaded", id)};
+
+        return sound;
+    }
+
+    bool MiniAudio::is_valid_sound(const int id)
+    {
+        const int index = id & SOUND_INDEX_MASK;
+        
+        if(id < 0 || index >= m_sounds.size())
+            return false;
+
+        return m_sounds[index].m_in_use && m_sounds[index].m_generation == ((id >> SOUND_INDEX_BITS) & SOUND_GENERATION_MASK);
+    }
+
+    const int MiniAudio::sound_id(const int index)
+    {
+        return (m_sounds[index].m_generation << SOUND_INDEX_BITS) | index;
+    }
+
+    void MiniAudio::sound_end_callback(void* pUserData, ma_sound* pSound)
+    {
+        Sound* sound = static_cast<Sound*>(pUserData);
+
+        if(!sound->m_owner->m_ended_sounds.Push(sound->m_id))
+            sound->m_owner->m_ended_sounds_overflowed.store(true);
+    }
+
+    bool MiniAudio::should_stream(const std::string& path, const LoadMode mode)
+    {
+        if(mode == LoadMode::Decode)
+            return false;
+
+        if(mode == LoadMode::Stream)
+            return true;
+
+        if(m_stream_threshold == 0)
+            return false;
+
+        std::error_code error;
+        std::uintmax_t size = std::filesystem::file_size(path, error);
+
+        return !error && size >= m_stream_threshold;
+    }
+
+    bool MiniAudio::acquire_pack_file(const std::string& path, olc::ResourcePack* pack, const LoadMode mode)
+    {
+        if(!pack->Loaded())
+            throw std::runtime_error{std::format("failed to load sound from: {} - olc::ResourcePack", path)};
+
+        std::shared_ptr<const std::vector<char>> data;
+        size_t size = 0;
+        int decoded_count = 0;
+        {
+            std::lock_guard<std::mutex> lock{m_pack_mutex};
+            PackEntry& entry = m_pack_entries[path];
+            data = entry.m_data;
+            size = entry.m_size;
+            decoded_count = entry.m_decoded_count;
+        }
+
+        auto read = [&]()
+        {
+            PGEX_MA_LOG(std::format("reading {} out of olc::ResourcePack", path));
+            data = std::make_shared<const std::vector<char>>(std::move(pack->GetFileBuffer(path).vMemory));
+            size = data->size();
+        };
+
+        /**
+         * Auto only needs the size when there's a threshold to hold it
+         * against, and the entry remembers it from the first read. the
+         * pack keeps its own file index to itself, so the very first
+         * load of a path has to read it.
+         */
+        bool stream = (mode == LoadMode::Stream);
+        
+        if(mode == LoadMode::Auto && m_stream_threshold != 0)
+        {
+            if(data == nullptr && size == 0)
+                read();
+
+            stream = (size >= m_stream_threshold);
+        }
+
+        /**
+         * read the file out of the pack, here on the game thread, only if
+         * this load will open it. a decoded sound of this path that's
+         * still loaded means the resource manager has the data already,
+         * and won't open the file again.
+         */
+        const bool opens = stream || decoded_count == 0;
+        
+        if(opens && data == nullptr)
+            read();
+
+        std::lock_guard<std::mutex> lock{m_pack_mutex};
+        PackEntry& entry = m_pack_entries[path];
+        entry.m_size = size;
+        
+        if(opens)
+            entry.m_data = data;
+        
+        if(stream)
+            entry.m_streamed_count++;
+        else
+            entry.m_decoded_count++;
+
+        return stream;
+    }
+
+    void MiniAudio::release_pack_file(const std::string& path, const bool streamed)
+    {
+        std::lock_guard<std::mutex> lock{m_pack_mutex};
+        
+        auto entry = m_pack_entries.find(path);
+        if(entry == m_pack_entries.end())
+            throw std::runtime_error{std::format("tried to release non-existent packed file at path ({})", path)};
+
+        if(streamed)
+            entry->second.m_streamed_count--;
+        else
+            entry->second.m_decoded_count--;
+
+        if(entry->second.m_streamed_count == 0 && entry->second.m_decoded_count == 0)
+            m_pack_entries.erase(entry);
+    }
+
+    void MiniAudio::acquire_sound_file(const std::string& path, olc::ResourcePack* pack)
+    {
+        if(pack != nullptr)
+        {
+            acquire_pack_file(path, pack, LoadMode::Decode);
+            return;
+        }
+
+        /**
+         * the resource manager opens files on disk itself, through
+         * m_pack_vfs, and decodes them into data it shares between
+         * every sound of the path. an asynchronous load would only
+         * fail later, on a job thread, so check the file is there
+         */
+        std::error_code error;
+        if(!std::filesystem::is_regular_file(path, error))
+            throw std::runtime_error{std::format("failed to load sound from: {}", path)};
+    }
+
+    void MiniAudio::release_sound_file(const std::string& path, const bool packed, const bool streamed)
+    {
+        if(packed)
+            release_pack_file(path, streamed);
+    }
+
+    ma_result MiniAudio::vfs_open(ma_vfs* pVFS, const char* pFilePath, ma_uint32 openMode, ma_vfs_file* pFile)
+    {
+        MiniAudio* ma = static_cast<PackVFS*>(pVFS)->m_owner;
+        PackFile* file = new PackFile;
+
+        {
+            std::lock_guard<std::mutex> lock{ma->m_pack_mutex};
+            
+            auto entry = ma->m_pack_entries.find(pFilePath);
+            if(entry != ma->m_pack_entries.end() && entry->second.m_data != nullptr)
+            {
+                file->m_data = entry->second.m_data;
+                file->m_path = pFilePath;
+            }
+        }
+
+        if(file->m_data != nullptr)
+        {
+            if(openMode & MA_OPEN_MODE_WRITE)
+            {
+                delete file;
+                return MA_ACCESS_DENIED;
+            }
+
+            file->m_bytes = file->m_data->data();
+            file->m_size = file->m_data->size();
+        }
+        else if((openMode & MA_OPEN_MODE_WRITE) || !map_file(pFilePath, *file))
+        {
+            ma_result result = ma_vfs_open(&ma->m_default_vfs, pFilePath, openMode, &file->m_default_file);
+            if(result != MA_SUCCESS)
+            {
+                delete file;
+                return result;
+            }
+        }
+
+        *pFile = file;
+        return MA_SUCCESS;
+    }
+
+    ma_result MiniAudio::vfs_open_w(ma_vfs* pVFS, const wchar_t* pFilePath, ma_uint32 openMode, ma_vfs_file* pFile)
+    {
+        /**
+         * packs are keyed by narrow paths, wide ones are always on disk
+         */
+        MiniAudio* ma = static_cast<PackVFS*>(pVFS)->m_owner;
+        PackFile* file = new PackFile;
+
+        ma_result result = ma_vfs_open_w(&ma->m_default_vfs, pFilePath, openMode, &file->m_default_file);
+        if(result != MA_SUCCESS)
+        {
+            delete file;
+            return result;
+        }
+
+        *pFile = file;
+        return MA_SUCCESS;
+    }
+
+    ma_result MiniAudio::vfs_close(ma_vfs* pVFS, ma_vfs_file file)
+    {
+        MiniAudio* ma = static_cast<PackVFS*>(pVFS)->m_owner;
+        PackFile* packFile = static_cast<PackFile*>(file);
+        ma_result result = MA_SUCCESS;
+
+        if(packFile->m_default_file != nullptr)
+        {
+            result = ma_vfs_close(&ma->m_default_vfs, packFile->m_default_file);
         }
-        
-        /**
-         * clamp the output to a range of -1.0f to 1.0f
-         */
-        for(auto &sample : m_engine_buffer)
+        else if(packFile->m_mapping != nullptr)
+        {
+        #ifdef PGEX_MA_MMAP
+            munmap(packFile->m_mapping, packFile->m_size);
+        #endif
+        }
+        else
         {
-            sample = std::clamp(sample, -1.0f, 1.0f);
+            /**
+             * a decoded sound is done with the file once it closes it,
+             * only streams need the encoded data for as long as they play
+             */
+            std::lock_guard<std::mutex> lock{ma->m_pack_mutex};
+            
+            auto entry = ma->m_pack_entries.find(packFile->m_path);
+            if(entry != ma->m_pack_entries.end() && entry->second.m_streamed_count == 0)
+                entry->second.m_data.reset();
         }
 
-        /**
-         * Copy the results to the output buffer
-         */
-        memcpy(pOutput, m_engine_buffer.data(), m_engine_buffer.size() * sizeof(float));
+        delete packFile;
+        return result;
     }
 
-    void MiniAudio::SetBackgroundPlay(bool state)
+    ma_result MiniAudio::vfs_read(ma_vfs* pVFS, ma_vfs_file file, void* pDst, size_t sizeInBytes, size_t* pBytesRead)
     {
-        MiniAudio::m_background_playback = state;
+        MiniAudio* ma = static_cast<PackVFS*>(pVFS)->m_owner;
+        PackFile* packFile = static_cast<PackFile*>(file);
+
+        if(packFile->m_default_file != nullptr)
+            return ma_vfs_read(&ma->m_default_vfs, packFile->m_default_file, pDst, sizeInBytes, pBytesRead);
+
+        size_t count = std::min(sizeInBytes, packFile->m_size - packFile->m_cursor);
+        std::memcpy(pDst, packFile->m_bytes + packFile->m_cursor, count);
+        packFile->m_cursor += count;
+
+        if(pBytesRead != nullptr)
+            *pBytesRead = count;
+
+        if(count == 0 && sizeInBytes > 0)
+            return MA_AT_END;
+
+        return MA_SUCCESS;
     }
 
-    const int MiniAudio::LoadSound(const std::string& path, olc::ResourcePack* pack, bool playOnce)
+    ma_result MiniAudio::vfs_write(ma_vfs* pVFS, ma_vfs_file file, const void* pSrc, size_t sizeInBytes, size_t* pBytesWritten)
     {
-        int id = find_or_create_empty_sound_slot();
+        MiniAudio* ma = static_cast<PackVFS*>(pVFS)->m_owner;
+        PackFile* packFile = static_cast<PackFile*>(file);
 
-        /**
-         * if we haven't already create a sound file buffer for this
-         * path, let's create it
-         */
-        if(m_sound_file_buffers.find(path) == m_sound_file_buffers.end())
-        {
-            m_sound_file_buffers[path] = SoundFileBuffer(&m_engine);
-        }
-        
-        m_sound_file_buffers.at(path).Load(path, pack);
+        if(packFile->m_default_file != nullptr)
+            return ma_vfs_write(&ma->m_default_vfs, packFile->m_default_file, pSrc, sizeInBytes, pBytesWritten);
+
+        return MA_ACCESS_DENIED;
+    }
+
+    ma_result MiniAudio::vfs_seek(ma_vfs* pVFS, ma_vfs_file file, ma_int64 offset, ma_seek_origin origin)
+    {
+        MiniAudio* ma = static_cast<PackVFS*>(pVFS)->m_owner;
+        PackFile* packFile = static_cast<PackFile*>(file);
+
+        if(packFile->m_default_file != nullptr)
+            return ma_vfs_seek(&ma->m_default_vfs, packFile->m_default_file, offset, origin);
+
+        ma_int64 base = 0;
         
-        if(ma_sound_init_from_file(&m_engine, path.c_str(), MA_SOUND_FLAG_DECODE | MA_SOUND_FLAG_ASYNC, NULL, NULL, &m_sounds.at(id)->m_sound) != MA_SUCCESS)
-            throw std::runtime_error{"PGEX_MiniAudio: failed to initialize a sound"};
+        if(origin == ma_seek_origin_current)
+            base = static_cast<ma_int64>(packFile->m_cursor);
+        else if(origin == ma_seek_origin_end)
+            base = static_cast<ma_int64>(packFile->m_size);
+
+        ma_int64 cursor = base + offset;
         
-        /**
-         * sounds with the play once flag set will be automatically
-         * unloaded when it has finished it's playback.
-         */
-        m_sounds.at(id)->m_play_once = playOnce;
+        if(cursor < 0 || cursor > static_cast<ma_int64>(packFile->m_size))
+            return MA_BAD_SEEK;
 
-        /**
-         * used to synchronise the underlying sound file buffers
-         */
-        m_sounds.at(id)->m_path = path;
+        packFile->m_cursor = static_cast<size_t>(cursor);
+        return MA_SUCCESS;
+    }
 
-        /**
-         * cache the lengths of the sound because this is an expensive operation, do it once
-         */
-        ma_sound_get_length_in_pcm_frames(&m_sounds[id]->m_sound, &m_sounds[id]->m_length_in_pcm_frames);
-        ma_sound_get_length_in_seconds(&m_sounds[id]->m_sound, &m_sounds[id]->m_length_in_seconds);
-        
-        PGEX_MA_LOG(m_sounds.at(id)->string());
-        return id;
+    ma_result MiniAudio::vfs_tell(ma_vfs* pVFS, ma_vfs_file file, ma_int64* pCursor)
+    {
+        MiniAudio* ma = static_cast<PackVFS*>(pVFS)->m_owner;
+        PackFile* packFile = static_cast<PackFile*>(file);
+
+        if(packFile->m_default_file != nullptr)
+            return ma_vfs_tell(&ma->m_default_vfs, packFile->m_default_file, pCursor);
+
+        *pCursor = static_cast<ma_int64>(packFile->m_cursor);
+        return MA_SUCCESS;
     }
 
-    void MiniAudio::UnloadSound(const int id)
+    ma_result MiniAudio::vfs_info(ma_vfs* pVFS, ma_vfs_file file, ma_file_info* pInfo)
     {
-        if(m_sounds.at(id) == nullptr)
-            throw std::runtime_error{std::format("tried to unload non-existent sound at id({})", id)};
-        
-        if(m_sound_file_buffers.find(m_sounds.at(id)->m_path) == m_sound_file_buffers.end())
-            throw std::runtime_error{std::format("tried to unload non-existent sound file buffer at path ({})", m_sounds.at(id)->m_path)};
-        
+        MiniAudio* ma = static_cast<PackVFS*>(pVFS)->m_owner;
+        PackFile* packFile = static_cast<PackFile*>(file);
+
+        if(packFile->m_default_file != nullptr)
+            return ma_vfs_info(&ma->m_default_vfs, packFile->m_default_file, pInfo);
+
+        pInfo->sizeInBytes = packFile->m_size;
+        return MA_SUCCESS;
+    }
+
+    bool MiniAudio::map_file(const char* pFilePath, PackFile& file)
+    {
+    #ifdef PGEX_MA_MMAP
         /**
-         * if the sound is playing, stop it
+         * the pages are read in lazily as the decoder touches them and
+         * are shared with every other process mapping the same file
+         * through the page cache, nothing is copied onto the heap
          */
-        if(ma_sound_is_playing(&m_sounds.at(id)->m_sound))
-            ma_sound_stop(&m_sounds.at(id)->m_sound);
+        int fd = open(pFilePath, O_RDONLY);
+        if(fd == -1)
+            return false;
         
-        /**
-         * let miniaudio perform it's uninitialization on the sound
-         */
-        ma_sound_uninit(&m_sounds.at(id)->m_sound);
+        struct stat info;
+        if(fstat(fd, &info) == -1 || info.st_size <= 0)
+        {
+            close(fd);
+            return false;
+        }
 
-        /**
-         * unload the sound file buffer
-         */
-        m_sound_file_buffers.at(m_sounds.at(id)->m_path).Unload();
+        void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        
+        // the mapping keeps the file alive, the descriptor isn't needed anymore
+        close(fd);
 
-        /**
-         * give the memory back to the os
-         */
-        delete m_sounds.at(id);
+        if(mapping == MAP_FAILED)
+            return false;
 
-        /**
-         * mark this slot as empy
-         */
-        m_sounds.at(id) = nullptr;
+        file.m_mapping = mapping;
+        file.m_bytes = static_cast<const char*>(mapping);
+        file.m_size = static_cast<size_t>(info.st_size);
+        return true;
+    #else
+        return false;
+    #endif
     }
 
-    void MiniAudio::Play(const int id, const bool looping)
+    void MiniAudio::SetDecodedCacheBudget(const size_t bytes)
     {
-        if(ma_sound_is_playing(&m_sounds.at(id)->m_sound))
-            return;
-        
-        if(looping)
-            ma_sound_set_looping(&m_sounds.at(id)->m_sound, true);
-        
-        ma_sound_start(&m_sounds.at(id)->m_sound);
+        m_decoded_budget = bytes;
     }
-    
-    const int MiniAudio::Play(const std::string& path, olc::ResourcePack* pack)
+
+    size_t MiniAudio::GetDecodedCacheSize()
     {
-        int id = LoadSound(path, pack, true);
-        ma_sound_start(&m_sounds.at(id)->m_sound);
-        m_count_play_once_sounds++;
-        return id;
+        return m_decoded_bytes;
     }
 
-    void MiniAudio::Stop(const int id)
+    void MiniAudio::track_decoded(const std::string& path, const ma_uint64 frames, const bool bank)
     {
-        if(!ma_sound_is_playing(&m_sounds.at(id)->m_sound))
-            return;
+        DecodedEntry& entry = m_decoded_entries[path];
         
-        ma_sound_stop(&m_sounds.at(id)->m_sound);
-        ma_sound_seek_to_pcm_frame(&m_sounds.at(id)->m_sound, 0);
+        /**
+         * every sound of a path shares one decoded copy in the resource
+         * manager, f32 at the engine's channel count, count it once
+         */
+        if(entry.m_sound_count == 0 && entry.m_bank_count == 0)
+        {
+            entry.m_bytes = static_cast<size_t>(frames * ma_get_bytes_per_frame(ma_format_f32, m_config.channels));
+            m_decoded_bytes += entry.m_bytes;
+        }
+
+        if(bank)
+            entry.m_bank_count++;
+        else
+            entry.m_sound_count++;
     }
 
-    void MiniAudio::Pause(const int id)
+    void MiniAudio::update_decoded(const std::string& path, const ma_uint64 frames)
     {
-        if(!ma_sound_is_playing(&m_sounds.at(id)->m_sound))
+        auto entry = m_decoded_entries.find(path);
+        if(entry == m_decoded_entries.end() || entry->second.m_bytes != 0)
             return;
-        
-        ma_sound_stop(&m_sounds.at(id)->m_sound);
+
+        entry->second.m_bytes = static_cast<size_t>(frames * ma_get_bytes_per_frame(ma_format_f32, m_config.channels));
+        m_decoded_bytes += entry->second.m_bytes;
     }
 
-    void MiniAudio::Toggle(const int id)
+    void MiniAudio::untrack_decoded(const std::string& path, const bool bank)
     {
-        if(ma_sound_is_playing(&m_sounds.at(id)->m_sound))
-        {
-            ma_sound_stop(&m_sounds.at(id)->m_sound);
+        auto entry = m_decoded_entries.find(path);
+        if(entry == m_decoded_entries.end())
             return;
+
+        if(bank)
+            entry->second.m_bank_count--;
+        else
+            entry->second.m_sound_count--;
+
+        if(entry->second.m_sound_count == 0 && entry->second.m_bank_count == 0)
+        {
+            m_decoded_bytes -= entry->second.m_bytes;
+            m_decoded_entries.erase(entry);
         }
-        
-        ma_sound_start(&m_sounds.at(id)->m_sound);
     }
 
-    void MiniAudio::Seek(const int id, const ma_uint64 milliseconds)
+    void MiniAudio::touch_decoded(const std::string& path)
     {
-        ma_uint64 frame_to_seek_to = (milliseconds * DEVICE_SAMPLE_RATE) / 1000;
-        ma_sound_seek_to_pcm_frame(&m_sounds.at(id)->m_sound, frame_to_seek_to);
+        auto entry = m_decoded_entries.find(path);
+        if(entry != m_decoded_entries.end())
+            entry->second.m_last_played = ++m_play_clock;
     }
 
-    void MiniAudio::Seek(const int id, const float& location)
+    void MiniAudio::enforce_decoded_budget()
     {
-        ma_uint64 frame_to_seek_to = static_cast<ma_uint64>(m_sounds.at(id)->m_length_in_pcm_frames * location);
-        ma_sound_seek_to_pcm_frame(&m_sounds.at(id)->m_sound, frame_to_seek_to);
-    }
+        if(m_decoded_budget == 0 || m_decoded_bytes <= m_decoded_budget)
+            return;
 
-    void MiniAudio::Forward(const int id, const ma_uint64 milliseconds)
-    {
-        ma_uint64 frame_to_seek_to;
+        /**
+         * the decoded data of a path only goes away once all of its
+         * sounds let go of it, so a path with any sound playing, or
+         * waiting to be reaped, can't be evicted
+         */
+        for(auto& [path, entry] : m_decoded_entries)
+            entry.m_busy = (entry.m_bank_count > 0);
 
-        // get the current position
-        ma_sound_get_cursor_in_pcm_frames(&m_sounds.at(id)->m_sound, &frame_to_seek_to);
-        
-        // calculate the step and add it to the current position
-        frame_to_seek_to += ((milliseconds * DEVICE_SAMPLE_RATE) / 1000);
+        for(Sound& sound : m_sounds)
+        {
+            if(!sound.m_in_use || sound.m_evicted || sound.m_streamed)
+                continue;
 
-        // seek to the new position
-        ma_sound_seek_to_pcm_frame(&m_sounds.at(id)->m_sound, frame_to_seek_to);
-    }
+            if(sound.m_play_once || ma_sound_is_playing(&sound.m_sound) || is_scheduled(sound) || !is_sound_loaded(sound))
+                m_decoded_entries.at(sound.m_path).m_busy = true;
+        }
 
-    void MiniAudio::Rewind(const int id, const ma_uint64 milliseconds)
-    {
-        ma_uint64 frame_to_seek_to;
+        std::vector<std::pair<ma_uint64, std::string>> candidates;
+        for(auto& [path, entry] : m_decoded_entries)
+        {
+            if(!entry.m_busy)
+                candidates.emplace_back(entry.m_last_played, path);
+        }
 
-        // get the current position
-        ma_sound_get_cursor_in_pcm_frames(&m_sounds.at(id)->m_sound, &frame_to_seek_to);
-        
-        // calculate the step and subtract it to the current position
-        frame_to_seek_to -= ((milliseconds * DEVICE_SAMPLE_RATE) / 1000);
+        std::sort(candidates.begin(), candidates.end());
 
-        // seek to the new position
-        ma_sound_seek_to_pcm_frame(&m_sounds.at(id)->m_sound, frame_to_seek_to);
-    }
+        /**
+         * least recently played first, until we're within the budget
+         */
+        for(auto& [last_played, path] : candidates)
+        {
+            if(m_decoded_bytes <= m_decoded_budget)
+                break;
 
-    void MiniAudio::SetVolume(const int id, const float& volume)
-    {
-        ma_sound_set_volume(&m_sounds.at(id)->m_sound, std::clamp(volume, 0.0f, 1.0f));
-    }
+            PGEX_MA_LOG(std::format("evicting decoded data of {}", path));
 
-    void MiniAudio::SetPan(const int id, const float& pan)
-    {
-        ma_sound_set_pan(&m_sounds.at(id)->m_sound, std::clamp(pan, -1.0f, 1.0f));
+            for(Sound& sound : m_sounds)
+            {
+                if(sound.m_in_use && !sound.m_evicted && !sound.m_streamed && sound.m_path == path)
+                    evict_sound(sound);
+            }
+        }
     }
 
-    void MiniAudio::SetPitch(const int id, const float& pitch)
+    void MiniAudio::evict_sound(Sound& sound)
     {
-        ma_sound_set_pitch(&m_sounds.at(id)->m_sound, std::max({0.0f, pitch}));
+        sound.m_saved_volume = ma_sound_get_volume(&sound.m_sound);
+        sound.m_saved_pan = ma_sound_get_pan(&sound.m_sound);
+        sound.m_saved_pitch = ma_sound_get_pitch(&sound.m_sound);
+        sound.m_saved_looping = ma_sound_is_looping(&sound.m_sound);
+        sound.m_saved_position = ma_sound_get_position(&sound.m_sound);
+        ma_sound_get_cursor_in_pcm_frames(&sound.m_sound, &sound.m_saved_cursor);
+        sound.m_saved_stop_frame = ma_node_get_state_time(&sound.m_sound, ma_node_state_stopped);
+
+        ma_sound_uninit(&sound.m_sound);
+        release_sound_file(sound.m_path, sound.m_pack != nullptr, false);
+        untrack_decoded(sound.m_path, false);
+
+        sound.m_evicted = true;
     }
 
-    bool MiniAudio::IsPlaying(const int id)
+    void MiniAudio::restore_sound(Sound& sound)
     {
-        if(ma_sound_is_playing(&m_sounds.at(id)->m_sound))
-            return true;
+        PGEX_MA_LOG(std::format("decoding {} again", sound.m_path));
         
-        return false;
-    }
-    
-    ma_uint64 MiniAudio::GetCursorMilliseconds(const int id)
-    {
-        ma_uint64 cursor;
-        ma_sound_get_cursor_in_pcm_frames(&m_sounds.at(id)->m_sound, &cursor);
-        return (cursor * 1000) / DEVICE_SAMPLE_RATE;
-    }
-    
-    float MiniAudio::GetCursorFloat(const int id)
-    {
-        float cursor;
-        ma_sound_get_cursor_in_seconds(&m_sounds.at(id)->m_sound, &cursor);
-        return cursor / m_sounds.at(id)->m_length_in_seconds;
+        acquire_sound_file(sound.m_path, sound.m_pack);
+
+        if(ma_sound_init_from_file(&m_engine, sound.m_path.c_str(), MA_SOUND_FLAG_DECODE | MA_SOUND_FLAG_ASYNC, bus_group(sound.m_bus), NULL, &sound.m_sound) != MA_SUCCESS)
+        {
+            release_sound_file(sound.m_path, sound.m_pack != nullptr, false);
+            throw std::runtime_error{std::format("PGEX_MiniAudio: failed to decode evicted sound {} again", sound.m_path)};
+        }
+
+        ma_sound_set_volume(&sound.m_sound, sound.m_saved_volume);
+        ma_sound_set_pan(&sound.m_sound, sound.m_saved_pan);
+        ma_sound_set_pitch(&sound.m_sound, sound.m_saved_pitch);
+        ma_sound_set_looping(&sound.m_sound, sound.m_saved_looping);
+        ma_sound_set_position(&sound.m_sound, sound.m_saved_position.x, sound.m_saved_position.y, sound.m_saved_position.z);
+        
+        ma_sound_set_stop_time_in_pcm_frames(&sound.m_sound, sound.m_saved_stop_frame);
+        
+        if(sound.m_saved_cursor != 0)
+            ma_sound_seek_to_pcm_frame(&sound.m_sound, sound.m_saved_cursor);
+
+        track_decoded(sound.m_path, sound.m_length_in_pcm_frames, false);
+        
+        sound.m_evicted = false;
+        
+        if(!sound.m_length_known)
+            m_pending_lengths.push_back(sound.m_id);
     }
 
-    int MiniAudio::GetOneOffCount()
+    MiniAudio::Sound& MiniAudio::resident_sound(const int id)
     {
-        return m_count_play_once_sounds;
+        Sound& sound = get_sound(id);
+        
+        if(sound.m_evicted)
+            restore_sound(sound);
+
+        return sound;
     }
 
-    const int MiniAudio::CreateWaveform(const double amplitude, const double frequency, const ma_waveform_type waveformType)
+    const int MiniAudio::LoadSoundsAsync(const std::vector<std::string>& paths, olc::ResourcePack* pack, const LoadMode mode, const int bus)
     {
-        // attempt to re-use an empty slot
-        for(int i = 0; i < m_waveforms.size(); i++)
+        bus_group(bus);
+
+        /**
+         * look for an empty slot for re-use, or make a new one
+         */
+        int batchId = -1;
+        for(int i = 0; i < m_load_batches.size(); i++)
         {
-            if(!m_waveforms.at(i).IsLoaded())
+            if(!m_load_batches.at(i).m_in_use)
             {
-                m_waveforms.at(i) = Waveform{amplitude, frequency, waveformType};
-                return i;
+                batchId = i;
+                break;
             }
         }
 
-        // no empty slots, make more room!
-        const int id = static_cast<int>(m_waveforms.size());
-        m_waveforms.emplace_back(amplitude, frequency, waveformType);
-        return id;
-    }
+        if(batchId == -1)
+        {
+            batchId = static_cast<int>(m_load_batches.size());
+            m_load_batches.emplace_back();
+        }
 
-    void MiniAudio::PlayWaveform(const int id)
-    {
-        m_waveforms.at(id).Start();
-    }
+        LoadBatch& batch = m_load_batches.at(batchId);
+        batch.m_sounds.clear();
+        batch.m_sounds.reserve(paths.size());
+        batch.m_fence = std::make_unique<ma_fence>();
 
-    void MiniAudio::SetWaveformAmplitude(const int id, const double amplitude)
-    {
-        ma_waveform_set_amplitude(m_waveforms.at(id).Get(), amplitude);
-    }
+        if(ma_fence_init(batch.m_fence.get()) != MA_SUCCESS)
+            throw std::runtime_error{"PGEX_MiniAudio: failed to initialize a load batch fence"};
 
-    void MiniAudio::SetWaveformFrequency(const int id, const double frequency)
-    {
-        ma_waveform_set_frequency(m_waveforms.at(id).Get(), frequency);
-    }
+        batch.m_in_use = true;
 
-    void MiniAudio::SetWaveformType(const int id, const ma_waveform_type waveformType)
-    {
-        ma_waveform_set_type(m_waveforms.at(id).Get(), waveformType);
-    }
+        /**
+         * every sound of the batch holds the fence until it's loaded,
+         * so it's only signalled once they're all done
+         */
+        try
+        {
+            for(const std::string& path : paths)
+                batch.m_sounds.push_back(load_sound(path, pack, false, mode, batch.m_fence.get(), bus));
+        }
+        catch(...)
+        {
+            /**
+             * let the sounds already started finish loading first,
+             * the resource manager still holds the fence for them
+             */
+            std::vector<int> started = std::move(batch.m_sounds);
+            ReleaseBatch(batchId);
+
+            for(int id : started)
+                UnloadSound(id);
+            
+            throw;
+        }
 
-    void MiniAudio::StopWaveform(const int id)
-    {
-        m_waveforms.at(id).Stop();
+        PGEX_MA_LOG(std::format("loading batch({}) of {} sounds", batchId, paths.size()));
+        return batchId;
     }
 
-    void MiniAudio::UnloadWaveform(const int id)
+    float MiniAudio::GetLoadProgress(const int batchId)
     {
-        ma_waveform_uninit(m_waveforms.at(id).Get());
-        m_waveforms.at(id).Unload();
-    }
+        LoadBatch& batch = get_batch(batchId);
 
-    ma_waveform* MiniAudio::GetWaveform(const int id)
-    {
-        return m_waveforms.at(id).Get();
+        if(batch.m_sounds.empty())
+            return 1.0f;
+
+        int loaded = 0;
+        for(int id : batch.m_sounds)
+        {
+            /**
+             * a sound unloaded since is as done as it's going to get
+             */
+            if(!is_valid_sound(id) || is_sound_loaded(get_sound(id)))
+                loaded++;
+        }
+
+        return static_cast<float>(loaded) / static_cast<float>(batch.m_sounds.size());
     }
 
-    const bool MiniAudio::IsWaveformPlaying(const int id)
+    bool MiniAudio::IsLoadComplete(const int batchId)
     {
-        return m_waveforms.at(id).IsPlaying();
+        return GetLoadProgress(batchId) >= 1.0f;
     }
 
-    const double& MiniAudio::GetWaveformAmplitude(const int id)
+    void MiniAudio::WaitForLoad(const int batchId)
     {
-        return m_waveforms.at(id).Get()->config.amplitude;
+        wait_for_fence(get_batch(batchId).m_fence.get());
+        update_pending_lengths();
     }
 
-    const double& MiniAudio::GetWaveformFrequency(const int id)
+    const std::vector<int>& MiniAudio::GetBatchSounds(const int batchId)
     {
-        return m_waveforms.at(id).Get()->config.frequency;
+        return get_batch(batchId).m_sounds;
     }
 
-    const ma_waveform_type& MiniAudio::GetWaveformType(const int id)
+    void MiniAudio::ReleaseBatch(const int batchId)
     {
-        return m_waveforms.at(id).Get()->config.type;
+        LoadBatch& batch = get_batch(batchId);
+
+        /**
+         * the resource manager may still be holding the fence
+         */
+        wait_for_fence(batch.m_fence.get());
+        ma_fence_uninit(batch.m_fence.get());
+
+        batch = LoadBatch{};
     }
 
-    void MiniAudio::SetNoiseCallback(std::function<void(float& noiseLeftChannel, float& noiseRightChannel, const float fElapsedTime)>callbackFunc)
+    void MiniAudio::wait_for_fence(ma_fence* pFence)
     {
-        m_noise_callback = callbackFunc;
+    #ifdef __EMSCRIPTEN__
+        /**
+         * there are no job threads here, the jobs only get done when
+         * we do them. waiting on the fence alone would never return,
+         * so work through the queue until it's empty first
+         */
+        ma_result result = MA_SUCCESS;
+        while(result != MA_NO_DATA_AVAILABLE && result != MA_CANCELLED)
+            result = ma_resource_manager_process_next_job(&m_resource_manager);
+    #endif
+
+        ma_fence_wait(pFence);
     }
 
-    void MiniAudio::ClearNoiseCallback()
+    MiniAudio::LoadBatch& MiniAudio::get_batch(const int batchId)
     {
-        MiniAudio::m_noise_left_channel = 0.0f;
-        MiniAudio::m_noise_right_channel = 0.0f;
-        m_noise_callback = {};
+        if(batchId < 0 || batchId >= m_load_batches.size() || !m_load_batches.at(batchId).m_in_use)
+            throw std::runtime_error{std::format("invalid load batch id({})", batchId)};
+
+        return m_load_batches.at(batchId);
     }
 
-    ma_device* MiniAudio::GetDevice()
+    bool MiniAudio::is_sound_loaded(Sound& sound)
     {
-        return &m_device;
+        if(sound.m_evicted)
+            return true;
+
+        ma_resource_manager_data_source* source = static_cast<ma_resource_manager_data_source*>(ma_sound_get_data_source(&sound.m_sound));
+        
+        return ma_resource_manager_data_source_result(source) != MA_BUSY;
     }
 
-    ma_engine* MiniAudio::GetEngine()
+    bool MiniAudio::is_scheduled(Sound& sound)
     {
-        return &m_engine;
+        if(sound.m_evicted || ma_node_get_state(&sound.m_sound) != ma_node_state_started)
+            return false;
+
+        /**
+         * started, but ma_sound_is_playing says no until the engine
+         * reaches the start time
+         */
+        return ma_node_get_state_time(&sound.m_sound, ma_node_state_started) > ma_engine_get_time_in_pcm_frames(&m_engine);
     }
 
-    ma_resource_manager* MiniAudio::GetResourceManager()
+    void MiniAudio::clear_schedule(Sound& sound)
     {
-        return &m_resource_manager;
+        /**
+         * a stop time left in the past would keep the sound from ever
+         * playing again
+         */
+        ma_sound_set_start_time_in_pcm_frames(&sound.m_sound, 0);
+        ma_sound_set_stop_time_in_pcm_frames(&sound.m_sound, ~static_cast<ma_uint64>(0));
     }
 
-    ma_sound* MiniAudio::GetSound(const int id)
+    bool MiniAudio::update_length(Sound& sound)
     {
-        if(id > (m_sounds.size() - 1))
-            return nullptr;
+        if(sound.m_length_known)
+            return true;
 
-        if(m_sounds.at(id) == nullptr)
-            return nullptr;
-        
-        return &m_sounds.at(id)->m_sound;
+        if(sound.m_evicted || !is_sound_loaded(sound))
+            return false;
+
+        ma_sound_get_length_in_pcm_frames(&sound.m_sound, &sound.m_length_in_pcm_frames);
+        ma_sound_get_length_in_seconds(&sound.m_sound, &sound.m_length_in_seconds);
+        sound.m_length_known = true;
+
+        if(!sound.m_streamed)
+            update_decoded(sound.m_path, sound.m_length_in_pcm_frames);
+
+        PGEX_MA_LOG(sound.string());
+        return true;
     }
 
-    const int MiniAudio::find_or_create_empty_sound_slot()
+    void MiniAudio::update_pending_lengths()
     {
-        /**
-         * look for empty slots for re-use
-         */
-        for(int i = 0; i < m_sounds.size(); i++)
+        for(int i = 0; i < m_pending_lengths.size();)
         {
-            if(m_sounds[i] == nullptr)
+            const int id = m_pending_lengths[i];
+
+            /**
+             * done with it once it's known, or the sound went away
+             */
+            if(!is_valid_sound(id) || get_sound(id).m_evicted || update_length(get_sound(id)))
             {
-                m_sounds.at(i) = new Sound();
-                return i;
+                m_pending_lengths[i] = m_pending_lengths.back();
+                m_pending_lengths.pop_back();
+                continue;
             }
-                
+
+            i++;
         }
+    }
+
+    void MiniAudio::reap_sound(const int id)
+    {
+        /**
+         * the sound may have been unloaded by hand since it ended
+         */
+        if(!is_valid_sound(id))
+            return;
+
+        Sound& sound = get_sound(id);
 
         /**
-         * create a new slot
+         * the end callback comes before miniaudio stops the sound, on
+         * its next pass, so it may well still be playing here. it's
+         * only not at its end if it was started again since
          */
-        int i = static_cast<int>(m_sounds.size());
-        m_sounds.push_back(new Sound());
-        return i;
+        if(!sound.m_play_once || !ma_sound_at_end(&sound.m_sound))
+            return;
+
+        UnloadSound(id);
+        m_count_play_once_sounds--;
     }
 
 #pragma endregion
@@ -0,0 +1,713 @@
+#include "olcPixelGameEngine.h"
+#include "olcPGEX_MiniAudio.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Regression tests, rendered offline so they run without an audio device.
+//
+// Where the output can be worked out by hand (waveforms, noise callbacks,
+// silence) it's checked exactly, or against the formula. check_golden
+// compares renders of real sounds to golden buffers in tests/golden, raw
+// interleaved f32. Run with --update-golden to write them after a change
+// to the output that's meant to be there, and listen to it first! A missing
+// golden fails its test, unless --allow-missing-golden says to skip it, so
+// only call it once the golden is recorded from a full build and committed.
+//
+// usage: tests [--update-golden] [--allow-missing-golden] [name filter]
+
+#ifndef GOLDEN_DIR
+    #define GOLDEN_DIR "tests/golden"
+#endif
+
+#define CHECK(condition) \
+    if(!(condition)) \
+        throw std::runtime_error{std::format("{}:{}: CHECK({}) failed", __FILE__, __LINE__, #condition)}
+
+#define CHECK_THROWS(statement) \
+    { \
+        bool threw = false; \
+        try { statement; } catch(const std::exception&) { threw = true; } \
+        if(!threw) \
+            throw std::runtime_error{std::format("{}:{}: CHECK_THROWS({}) didn't throw", __FILE__, __LINE__, #statement)}; \
+    }
+
+#define TEST(name) \
+    void name(); \
+    Registrar name##_registrar{#name, name}; \
+    void name()
+
+struct Test
+{
+    const char* name;
+    void (*run)();
+};
+
+std::vector<Test>& registry()
+{
+    static std::vector<Test> tests;
+    return tests;
+}
+
+struct Registrar
+{
+    Registrar(const char* name, void (*run)())
+    {
+        registry().push_back({name, run});
+    }
+};
+
+// the PGEX needs a PixelGameEngine to register with, it's never started
+olc::PixelGameEngine pge;
+
+bool updateGolden = false;
+bool allowMissingGolden = false;
+int goldenMissing = 0;
+
+// -80dB, room for the SIMD kernels and the libm of another machine
+constexpr float GOLDEN_TOLERANCE = 1.0e-4f;
+
+constexpr ma_uint32 SAMPLE_RATE = 48000;
+constexpr ma_uint32 CHANNELS = 2;
+
+olc::MiniAudio::Config offline_config()
+{
+    olc::MiniAudio::Config config;
+    config.offline = true;
+    config.channels = CHANNELS;
+    config.sampleRate = SAMPLE_RATE;
+    return config;
+}
+
+std::vector<float> render(olc::MiniAudio& ma, const ma_uint64 frames)
+{
+    std::vector<float> output(static_cast<size_t>(frames * CHANNELS));
+    ma.Render(output.data(), frames);
+    return output;
+}
+
+ma_uint64 milliseconds_to_frames(const ma_uint64 milliseconds)
+{
+    return milliseconds * SAMPLE_RATE / 1000;
+}
+
+bool is_silent(const std::vector<float>& buffer)
+{
+    for(const float sample : buffer)
+    {
+        if(sample != 0.0f)
+            return false;
+    }
+
+    return true;
+}
+
+float rms(const std::vector<float>& buffer)
+{
+    double sum = 0.0;
+    for(const float sample : buffer)
+        sum += sample * sample;
+
+    return static_cast<float>(std::sqrt(sum / buffer.size()));
+}
+
+// loads a decoded sound and waits for it, so it's ready to play on the next render
+int load_decoded(olc::MiniAudio& ma, const std::string& path)
+{
+    const int batch = ma.LoadSoundsAsync({path}, nullptr, olc::MiniAudio::LoadMode::Decode);
+    ma.WaitForLoad(batch);
+
+    const int id = ma.GetBatchSounds(batch).front();
+    ma.ReleaseBatch(batch);
+    return id;
+}
+
+void check_golden(const std::string& name, const std::vector<float>& buffer)
+{
+    const std::string path = std::format("{}/{}.f32", GOLDEN_DIR, name);
+
+    if(updateGolden)
+    {
+        std::filesystem::create_directories(GOLDEN_DIR);
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(float));
+        std::printf("       wrote %s\n", path.c_str());
+        return;
+    }
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if(!file.is_open())
+    {
+        if(!allowMissingGolden)
+            throw std::runtime_error{std::format("{}: no golden at {}, run with --update-golden to record one", name, path)};
+
+        std::printf("       no golden at %s, skipped\n", path.c_str());
+        goldenMissing++;
+        return;
+    }
+
+    std::vector<float> golden(static_cast<size_t>(file.tellg()) / sizeof(float));
+    file.seekg(0, std::ios::beg);
+    file.read(reinterpret_cast<char*>(golden.data()), golden.size() * sizeof(float));
+
+    if(golden.size() != buffer.size())
+        throw std::runtime_error{std::format("{}: rendered {} samples, the golden has {}", name, buffer.size(), golden.size())};
+
+    for(size_t i = 0; i < buffer.size(); i++)
+    {
+        if(std::abs(buffer[i] - golden[i]) > GOLDEN_TOLERANCE)
+        {
+            throw std::runtime_error{std::format("{}: frame {} channel {} is {}, the golden has {}",
+                name, i / CHANNELS, i % CHANNELS, buffer[i], golden[i])};
+        }
+    }
+}
+
+#pragma region sounds
+
+TEST(sound_plays)
+{
+    olc::MiniAudio ma{offline_config()};
+    const int id = load_decoded(ma, "assets/sounds/SampleA.wav");
+
+    ma.Play(id);
+    CHECK(ma.IsPlaying(id));
+
+    std::vector<float> output = render(ma, milliseconds_to_frames(500));
+    CHECK(rms(output) > 0.01f);
+}
+
+TEST(sound_stop_rewinds_and_silences)
+{
+    olc::MiniAudio ma{offline_config()};
+    const int id = load_decoded(ma, "assets/sounds/SampleA.wav");
+
+    ma.Play(id);
+    render(ma, milliseconds_to_frames(250));
+    CHECK(ma.GetCursorMilliseconds(id) > 0);
+
+    ma.Stop(id);
+    CHECK(!ma.IsPlaying(id));
+    CHECK(ma.GetCursorMilliseconds(id) == 0);
+    CHECK(is_silent(render(ma, milliseconds_to_frames(100))));
+}
+
+TEST(sound_pause_keeps_position)
+{
+    olc::MiniAudio ma{offline_config()};
+    const int id = load_decoded(ma, "assets/sounds/SampleA.wav");
+
+    ma.Play(id);
+    render(ma, milliseconds_to_frames(250));
+
+    ma.Pause(id);
+    const ma_uint64 cursor = ma.GetCursorMilliseconds(id);
+    CHECK(cursor > 0);
+    CHECK(is_silent(render(ma, milliseconds_to_frames(100))));
+    CHECK(ma.GetCursorMilliseconds(id) == cursor);
+
+    ma.Toggle(id);
+    CHECK(ma.IsPlaying(id));
+    CHECK(!is_silent(render(ma, milliseconds_to_frames(100))));
+}
+
+TEST(sound_seek)
+{
+    olc::MiniAudio ma{offline_config()};
+    const int id = load_decoded(ma, "assets/sounds/SampleA.wav");
+
+    ma.Seek(id, static_cast<ma_uint64>(1000));
+    ma.Play(id);
+
+    std::vector<float> output = render(ma, milliseconds_to_frames(100));
+
+    const ma_uint64 cursor = ma.GetCursorMilliseconds(id);
+    CHECK(cursor >= 1090 && cursor <= 1110);
+
+    ma.Rewind(id, 5000);
+    render(ma, milliseconds_to_frames(10));
+    CHECK(ma.GetCursorMilliseconds(id) <= 20);
+}
+
+TEST(sound_play_at_lands_on_its_frame)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    const int id = load_decoded(ma, "assets/sounds/SampleA.wav");
+    render(ma, 1000);
+
+    const ma_uint64 now = ma.GetEngineTimeInFrames();
+    CHECK(now == 1000);
+
+    ma.PlayAt(id, now + 200);
+    ma.StopAt(id, now + milliseconds_to_frames(100));
+
+    std::vector<float> output = render(ma, milliseconds_to_frames(200));
+    const size_t start = 200 * CHANNELS;
+    const size_t stop = milliseconds_to_frames(100) * CHANNELS;
+
+    CHECK(is_silent({output.begin(), output.begin() + start}));
+    CHECK(!is_silent({output.begin() + start, output.begin() + stop}));
+    CHECK(is_silent({output.begin() + stop, output.end()}));
+
+    // a plain Play afterwards isn't held back by the old stop time
+    ma.Play(id);
+    CHECK(!is_silent(render(ma, milliseconds_to_frames(50))));
+}
+
+TEST(one_off_sounds_are_reaped)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    ma.Play("assets/sounds/SampleA.wav");
+    CHECK(ma.GetOneOffCount() == 1);
+
+    // the sound starts once it's decoded, give it far longer than it lasts
+    float elapsed = 0.0f;
+    for(int i = 0; i < 100 && ma.GetOneOffCount() > 0; i++)
+    {
+        render(ma, milliseconds_to_frames(100));
+        ma.OnBeforeUserUpdate(elapsed);
+    }
+
+    CHECK(ma.GetOneOffCount() == 0);
+}
+
+TEST(one_off_sounds_are_reaped_between_blocks)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    ma.Play("assets/sounds/SampleA.wav");
+
+    // a frame after every block, so one lands between the end callback and the sound stopping
+    float elapsed = 0.0f;
+    for(int i = 0; i < 1000 && ma.GetOneOffCount() > 0; i++)
+    {
+        render(ma, 480);
+        ma.OnBeforeUserUpdate(elapsed);
+    }
+
+    CHECK(ma.GetOneOffCount() == 0);
+}
+
+TEST(stale_sound_ids_are_rejected)
+{
+    olc::MiniAudio ma{offline_config()};
+    const int id = load_decoded(ma, "assets/sounds/SampleA.wav");
+
+    ma.UnloadSound(id);
+    CHECK_THROWS(ma.IsPlaying(id));
+
+    // the slot is reused, the old id still mustn't reach the new sound
+    const int reused = load_decoded(ma, "assets/sounds/SampleB.wav");
+    CHECK(reused != id);
+    CHECK_THROWS(ma.Play(id));
+}
+
+TEST(sound_bank_shares_one_decoded_copy)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    // a bank that fails to load leaves nothing behind
+    const std::string garbage = "not_a_sound.wav";
+    std::ofstream{garbage} << "not a sound";
+    CHECK_THROWS(ma.LoadSoundBank(garbage, 4));
+    std::filesystem::remove(garbage);
+    CHECK(ma.GetDecodedCacheSize() == 0);
+
+    const int bank = ma.LoadSoundBank("assets/sounds/SampleA.wav", 4);
+    const size_t size = ma.GetDecodedCacheSize();
+    CHECK(size > 0);
+
+    // a sound of the same path reads the bank's decoded data too
+    load_decoded(ma, "assets/sounds/SampleA.wav");
+    CHECK(ma.GetDecodedCacheSize() == size);
+
+    ma.PlaySoundBank(bank);
+    CHECK(!is_silent(render(ma, milliseconds_to_frames(50))));
+}
+
+TEST(bus_controls_its_sounds)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    const int parent = ma.CreateBus();
+    const int bus = ma.CreateBus(parent);
+
+    const int batch = ma.LoadSoundsAsync({"assets/sounds/SampleA.wav"}, nullptr, olc::MiniAudio::LoadMode::Decode, bus);
+    ma.WaitForLoad(batch);
+    const int id = ma.GetBatchSounds(batch).front();
+
+    ma.Play(id);
+    CHECK(!is_silent(render(ma, milliseconds_to_frames(50))));
+
+    // a nested bus answers to its parent
+    ma.SetBusVolume(parent, 0.0f);
+    CHECK(is_silent(render(ma, milliseconds_to_frames(50))));
+    ma.SetBusVolume(parent, 1.0f);
+
+    ma.PauseBus(bus);
+    CHECK(ma.IsBusPaused(bus));
+    const ma_uint64 cursor = ma.GetCursorMilliseconds(id);
+    CHECK(is_silent(render(ma, milliseconds_to_frames(50))));
+    CHECK(ma.GetCursorMilliseconds(id) == cursor);
+
+    ma.ResumeBus(bus);
+    CHECK(!is_silent(render(ma, milliseconds_to_frames(50))));
+
+    // unloading the buses hands the sound over to the output
+    ma.UnloadBus(parent);
+    ma.UnloadBus(bus);
+    CHECK(!is_silent(render(ma, milliseconds_to_frames(50))));
+    CHECK_THROWS(ma.SetBusVolume(bus, 1.0f));
+}
+
+#pragma endregion
+
+#pragma region waveforms
+
+TEST(waveform_sine_matches_formula)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    const double amplitude = 0.5;
+    const double frequency = 440.0;
+    const int id = ma.CreateWaveform(amplitude, frequency, ma_waveform_type_sine);
+    ma.PlayWaveform(id);
+
+    std::vector<float> output = render(ma, milliseconds_to_frames(100));
+
+    for(size_t frame = 0; frame < output.size() / CHANNELS; frame++)
+    {
+        const float expected = static_cast<float>(amplitude * std::sin(2.0 * 3.14159265358979323846 * frequency * frame / SAMPLE_RATE));
+
+        for(ma_uint32 channel = 0; channel < CHANNELS; channel++)
+            CHECK(std::abs(output[frame * CHANNELS + channel] - expected) < 1.0e-4f);
+    }
+}
+
+TEST(waveforms_mix)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    const ma_waveform_type types[] = {
+        ma_waveform_type_sine,
+        ma_waveform_type_square,
+        ma_waveform_type_triangle,
+        ma_waveform_type_sawtooth,
+    };
+
+    for(int i = 0; i < 4; i++)
+        ma.PlayWaveform(ma.CreateWaveform(0.2, 110.0 * (i + 1), types[i]));
+
+    std::vector<float> output = render(ma, milliseconds_to_frames(100));
+    CHECK(rms(output) > 0.05f);
+
+    // the naive shapes summed, skipping the frames right on a step where rounding decides the side
+    for(size_t frame = 0; frame < output.size() / CHANNELS; frame++)
+    {
+        float expected = 0.0f;
+        bool onStep = false;
+
+        for(int i = 0; i < 4; i++)
+        {
+            const double cycles = 110.0 * (i + 1) * frame / SAMPLE_RATE;
+            const double phase = cycles - std::floor(cycles);
+            const double saw = 2.0 * phase - 1.0;
+
+            onStep |= (std::abs(phase - 0.5) < 1.0e-6 || phase < 1.0e-6 || phase > 1.0 - 1.0e-6) && types[i] != ma_waveform_type_sine;
+
+            switch(types[i])
+            {
+                case ma_waveform_type_sine:     expected += static_cast<float>(0.2 * std::sin(2.0 * 3.14159265358979323846 * phase)); break;
+                case ma_waveform_type_square:   expected += (phase < 0.5) ? 0.2f : -0.2f; break;
+                case ma_waveform_type_triangle: expected += static_cast<float>(0.2 * (2.0 * std::abs(saw) - 1.0)); break;
+                default:                        expected += static_cast<float>(0.2 * saw); break;
+            }
+        }
+
+        if(onStep)
+            continue;
+
+        for(ma_uint32 channel = 0; channel < CHANNELS; channel++)
+            CHECK(std::abs(output[frame * CHANNELS + channel] - expected) < 1.0e-4f);
+    }
+}
+
+TEST(band_limited_saw_only_differs_at_the_wrap)
+{
+    olc::MiniAudio naive{offline_config()};
+    olc::MiniAudio bandLimited{offline_config()};
+
+    const double frequency = 440.0;
+    naive.PlayWaveform(naive.CreateWaveform(0.5, frequency, ma_waveform_type_sawtooth));
+    bandLimited.PlayWaveform(bandLimited.CreateWaveform(0.5, frequency, ma_waveform_type_sawtooth, true));
+
+    std::vector<float> a = render(naive, milliseconds_to_frames(100));
+    std::vector<float> b = render(bandLimited, milliseconds_to_frames(100));
+
+    // the correction only touches the sample either side of each wrap
+    size_t differing = 0;
+    for(size_t i = 0; i < a.size(); i += CHANNELS)
+    {
+        if(std::abs(a[i] - b[i]) > 1.0e-5f)
+            differing++;
+
+        CHECK(std::abs(b[i]) <= 0.5f + 1.0e-4f);
+    }
+
+    const size_t cycles = static_cast<size_t>(frequency * 0.1) + 1;
+    CHECK(differing > 0);
+    CHECK(differing <= cycles * 2);
+}
+
+TEST(generators_follow_their_bus)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    const int bus = ma.CreateBus();
+    ma.SetWaveformBus(bus);
+    ma.SetNoiseBus(bus);
+
+    ma.PlayWaveform(ma.CreateWaveform(0.25, 440.0, ma_waveform_type_square));
+    ma.SetNoiseCallback([](float& left, float& right, const float fElapsedTime)
+    {
+        left = 0.1f;
+        right = 0.1f;
+    });
+    CHECK(!is_silent(render(ma, 480)));
+
+    ma.SetBusVolume(bus, 0.0f);
+    CHECK(is_silent(render(ma, 480)));
+
+    // unloading the bus hands them over to the output
+    ma.UnloadBus(bus);
+    CHECK(!is_silent(render(ma, 480)));
+}
+
+TEST(waveform_play_at_is_sample_accurate)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    const int id = ma.CreateWaveform(0.5, 440.0, ma_waveform_type_square);
+    render(ma, 1000);
+
+    const ma_uint64 now = ma.GetEngineTimeInFrames();
+    ma.PlayWaveformAt(id, now + 123);
+    ma.StopWaveformAt(id, now + 456);
+    CHECK(!ma.IsWaveformPlaying(id));
+
+    std::vector<float> output = render(ma, 1000);
+    for(size_t frame = 0; frame < 1000; frame++)
+    {
+        const bool playing = (frame >= 123 && frame < 456);
+        CHECK((output[frame * CHANNELS] != 0.0f) == playing);
+    }
+
+    // a plain stop cancels whatever was scheduled
+    ma.PlayWaveformAt(id, ma.GetEngineTimeInFrames() + 100);
+    ma.StopWaveform(id);
+    CHECK(is_silent(render(ma, 1000)));
+}
+
+TEST(waveform_stop_silences)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    const int id = ma.CreateWaveform(0.5, 440.0, ma_waveform_type_square);
+    ma.PlayWaveform(id);
+    CHECK(!is_silent(render(ma, 480)));
+
+    ma.StopWaveform(id);
+    CHECK(is_silent(render(ma, 480)));
+}
+
+#pragma endregion
+
+#pragma region synth
+
+olc::MiniAudio::Instrument test_instrument()
+{
+    olc::MiniAudio::Instrument instrument;
+    instrument.partials[0] = {ma_waveform_type_sine, 0.0f, 0.5f};
+    instrument.envelope = {0.01f, 0.01f, 0.5f, 0.05f};
+    return instrument;
+}
+
+TEST(synth_note_follows_its_envelope)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    const int instrument = ma.CreateInstrument(test_instrument());
+    const int note = ma.NoteOn(instrument, 440.0f);
+
+    // attack and decay, then it settles on the sustain level of 0.5 * 0.5
+    std::vector<float> attack = render(ma, milliseconds_to_frames(20));
+    CHECK(std::abs(attack[0]) < 0.01f);
+    CHECK(ma.GetActiveVoiceCount() == 1);
+
+    std::vector<float> sustain = render(ma, milliseconds_to_frames(100));
+    CHECK(std::abs(rms(sustain) - 0.25f / std::sqrt(2.0f)) < 0.01f);
+
+    // released, it fades out over 50ms and frees its voice
+    ma.NoteOff(note);
+    render(ma, milliseconds_to_frames(60));
+    CHECK(ma.GetActiveVoiceCount() == 0);
+    CHECK(is_silent(render(ma, 480)));
+}
+
+TEST(synth_steals_voices)
+{
+    olc::MiniAudio::Config config = offline_config();
+    config.maxVoices = 4;
+    olc::MiniAudio ma{config};
+
+    const int instrument = ma.CreateInstrument(test_instrument());
+
+    for(int i = 0; i < 6; i++)
+        ma.NoteOn(instrument, 220.0f + i * 55.0f, 0.25f);
+
+    render(ma, 480);
+    CHECK(ma.GetActiveVoiceCount() == 4);
+
+    ma.AllNotesOff();
+    render(ma, milliseconds_to_frames(60));
+    CHECK(ma.GetActiveVoiceCount() == 0);
+}
+
+TEST(synth_unload_instrument_cuts_its_notes)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    const int instrument = ma.CreateInstrument(test_instrument());
+    ma.NoteOn(instrument, 440.0f);
+    render(ma, 480);
+    CHECK(ma.GetActiveVoiceCount() == 1);
+
+    ma.UnloadInstrument(instrument);
+    CHECK(is_silent(render(ma, 480)));
+    CHECK(ma.GetActiveVoiceCount() == 0);
+    CHECK_THROWS(ma.NoteOn(instrument, 440.0f));
+}
+
+#pragma endregion
+
+#pragma region noise
+
+TEST(noise_block_callback_frame_clock)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    // a ramp of the frame clock, any gap or overlap between blocks shows up
+    ma.SetNoiseBlockCallback([](float* noiseData, const ma_uint32 frameCount, const ma_uint32 channels, const ma_uint64 frameClock)
+    {
+        for(ma_uint32 i = 0; i < frameCount; i++)
+        {
+            for(ma_uint32 c = 0; c < channels; c++)
+                noiseData[i * channels + c] = static_cast<float>((frameClock + i) % 97) / 1000.0f;
+        }
+    });
+
+    ma_uint64 frameClock = 0;
+    for(const ma_uint64 frames : {100, 1000, 777, 9000})
+    {
+        std::vector<float> output = render(ma, frames);
+
+        for(ma_uint64 i = 0; i < frames; i++, frameClock++)
+        {
+            for(ma_uint32 c = 0; c < CHANNELS; c++)
+                CHECK(output[i * CHANNELS + c] == static_cast<float>(frameClock % 97) / 1000.0f);
+        }
+    }
+}
+
+TEST(noise_callback_channels)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    ma.SetNoiseCallback([](float& left, float& right, const float fElapsedTime)
+    {
+        left = 0.25f;
+        right = -0.5f;
+    });
+
+    std::vector<float> output = render(ma, 1024);
+    for(size_t i = 0; i < output.size(); i += CHANNELS)
+    {
+        CHECK(output[i] == 0.25f);
+        CHECK(output[i + 1] == -0.5f);
+    }
+
+    ma.ClearNoiseCallback();
+    CHECK(is_silent(render(ma, 1024)));
+}
+
+TEST(output_is_clamped)
+{
+    olc::MiniAudio ma{offline_config()};
+
+    ma.SetNoiseCallback([](float& left, float& right, const float fElapsedTime)
+    {
+        left = 2.0f;
+        right = -3.0f;
+    });
+
+    std::vector<float> output = render(ma, 1024);
+    for(size_t i = 0; i < output.size(); i += CHANNELS)
+    {
+        CHECK(output[i] == 1.0f);
+        CHECK(output[i + 1] == -1.0f);
+    }
+}
+
+#pragma endregion
+
+int main(int argc, char* argv[])
+{
+    std::string filter;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--update-golden") == 0)
+            updateGolden = true;
+        else if(std::strcmp(argv[i], "--allow-missing-golden") == 0)
+            allowMissingGolden = true;
+        else
+            filter = argv[i];
+    }
+
+    int passed = 0;
+    int failed = 0;
+
+    for(const Test& test : registry())
+    {
+        if(!filter.empty() && std::string(test.name).find(filter) == std::string::npos)
+            continue;
+
+        try
+        {
+            test.run();
+            std::printf("[ OK ] %s\n", test.name);
+            passed++;
+        }
+        catch(const std::exception& e)
+        {
+            std::printf("[FAIL] %s\n       %s\n", test.name, e.what());
+            failed++;
+        }
+    }
+
+    std::printf("\n%d passed, %d failed", passed, failed);
+    if(goldenMissing > 0)
+        std::printf(", %d golden comparisons skipped", goldenMissing);
+    std::printf("\n");
+
+    return (failed == 0) ? 0 : 1;
+}